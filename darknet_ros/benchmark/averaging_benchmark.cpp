@@ -0,0 +1,103 @@
+/*
+ * averaging_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Temporal averaging of the outputs of the three YOLO heads of YOLOv3 at
+ *  416x416, summing all stored frames on every frame like the node did before
+ *  and with the running sum of PredictionAverager.
+ */
+
+// c++
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Temporal averaging of the predictions.
+#include "darknet_ros/prediction_averaging.hpp"
+
+namespace {
+
+// The stored frames summed into avg on every frame and copied back into the
+// outputs, as rememberNetwork and avgPredictions did.
+class SummingAverager {
+ public:
+  SummingAverager(size_t total, int frames) : frames_(frames), predictions_(frames, std::vector<float>(total)), avg_(total) {}
+
+  void update(network* net, int, int) {
+    size_t count = 0;
+    for (int i = 0; i < net->n; ++i) {
+      const layer& l = net->layers[i];
+      memcpy(predictions_[index_].data() + count, l.output, sizeof(float) * l.outputs * l.batch);
+      count += l.outputs * l.batch;
+    }
+    std::fill(avg_.begin(), avg_.end(), 0.f);
+    for (int j = 0; j < frames_; ++j) {
+      for (size_t k = 0; k < avg_.size(); ++k) avg_[k] += predictions_[j][k] / frames_;
+    }
+    count = 0;
+    for (int i = 0; i < net->n; ++i) {
+      const layer& l = net->layers[i];
+      memcpy(l.output, avg_.data() + count, sizeof(float) * l.outputs * l.batch);
+      count += l.outputs * l.batch;
+    }
+    index_ = (index_ + 1) % frames_;
+  }
+
+ private:
+  int frames_;
+  int index_ = 0;
+  std::vector<std::vector<float> > predictions_;
+  std::vector<float> avg_;
+};
+
+template <typename Averager>
+double microsecondsPerFrame(Averager& averager, network* net, int iterations) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    // A new prediction comes in every frame.
+    net->layers[0].output[i % net->layers[0].outputs] += 1;
+    averager.update(net, 0, 1);
+  }
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int iterations = (argc > 1) ? atoi(argv[1]) : 200;
+
+  // 3 anchors of 80 classes on 13x13, 26x26 and 52x52 cells.
+  const int sides[] = {13, 26, 52};
+  std::vector<layer> layers(3, layer());
+  std::vector<std::vector<float> > outputs(3);
+  size_t total = 0;
+  for (int i = 0; i < 3; ++i) {
+    layers[i].type = YOLO;
+    layers[i].batch = 1;
+    layers[i].outputs = sides[i] * sides[i] * 3 * 85;
+    outputs[i].resize(layers[i].outputs);
+    for (float& value : outputs[i]) value = static_cast<float>(rand()) / RAND_MAX;
+    layers[i].output = outputs[i].data();
+    total += layers[i].outputs;
+  }
+  network net = network();
+  net.batch = 1;
+  net.n = layers.size();
+  net.layers = layers.data();
+
+  printf("%zu outputs, %d iterations\n", total, iterations);
+  printf("%-8s %14s %14s\n", "frames", "summing", "running sum");
+  const int frameCounts[] = {1, 3, 5, 10};
+  for (int frames : frameCounts) {
+    SummingAverager summing(total, frames);
+    darknet_ros::PredictionAverager running;
+    running.resize(&net, frames);
+    printf("%-8d %11.1f us %11.1f us\n", frames, microsecondsPerFrame(summing, &net, iterations),
+           microsecondsPerFrame(running, &net, iterations));
+  }
+  return 0;
+}
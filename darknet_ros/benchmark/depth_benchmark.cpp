@@ -0,0 +1,64 @@
+/*
+ * depth_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Depth statistics of the boxes of a frame on a 1280x720 depth image with
+ *  holes, with one and with several threads.
+ */
+
+// c++
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Depth statistics of boxes.
+#include "darknet_ros/depth_statistics.hpp"
+
+namespace {
+
+double microsecondsPerFrame(darknet_ros::DepthEstimator& estimator, const cv::Mat& depth, const std::vector<cv::Rect>& boxes, int iterations) {
+  std::vector<float> depths(boxes.size());
+  estimator.estimate(depth, boxes.data(), boxes.size(), depths.data());
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) estimator.estimate(depth, boxes.data(), boxes.size(), depths.data());
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int count = (argc > 1) ? atoi(argv[1]) : 50;
+  const int threads = (argc > 2) ? atoi(argv[2]) : 4;
+  const int iterations = (argc > 3) ? atoi(argv[3]) : 500;
+
+  // A slanted floor with 10% holes.
+  cv::Mat depth(720, 1280, CV_16UC1);
+  srand(1);
+  for (int y = 0; y < depth.rows; ++y) {
+    uint16_t* row = depth.ptr<uint16_t>(y);
+    for (int x = 0; x < depth.cols; ++x) row[x] = rand() % 10 == 0 ? 0 : 6000 - 6 * y + rand() % 50;
+  }
+  std::vector<cv::Rect> boxes;
+  for (int i = 0; i < count; ++i) {
+    const int width = 40 + rand() % 360;
+    const int height = 40 + rand() % 360;
+    boxes.push_back(cv::Rect(rand() % (depth.cols - width), rand() % (depth.rows - height), width, height));
+  }
+
+  const char* const names[] = {"center", "median", "trimmed_mean", "percentile"};
+  printf("%d boxes, %d iterations\n", count, iterations);
+  printf("%-14s %14s %14s\n", "", "1 thread", "threads");
+  for (const char* name : names) {
+    darknet_ros::DepthStatistic_ statistic;
+    darknet_ros::parseDepthStatistic(name, statistic);
+    darknet_ros::DepthEstimator single(statistic, .5, .1, .2, 1);
+    darknet_ros::DepthEstimator parallel(statistic, .5, .1, .2, threads);
+    printf("%-14s %11.1f us %11.1f us\n", name, microsecondsPerFrame(single, depth, boxes, iterations),
+           microsecondsPerFrame(parallel, depth, boxes, iterations));
+  }
+  return 0;
+}
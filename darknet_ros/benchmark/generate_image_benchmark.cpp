@@ -0,0 +1,71 @@
+/*
+ * generate_image_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Per-frame cost of converting the planar float detection image into the
+ *  interleaved 8 bit image that is published.
+ */
+
+// c++
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Image interface.
+#include "darknet_ros/image_interface.hpp"
+
+namespace {
+
+// The conversion generate_image did before: a channel swap of the source and
+// a get_pixel call per byte.
+void generateImagePixelLoop(image p, cv::Mat& disp) {
+  if (p.c == 3) rgbgr_image(p);
+  int step = disp.step;
+  for (int y = 0; y < p.h; ++y) {
+    for (int x = 0; x < p.w; ++x) {
+      for (int k = 0; k < p.c; ++k) {
+        assert(x < p.w && y < p.h && k < p.c);
+        disp.data[y * step + x * p.c + k] = (unsigned char)(p.data[k * p.h * p.w + y * p.w + x] * 255);
+      }
+    }
+  }
+}
+
+template <typename Function>
+double millisecondsPerFrame(Function function, int frames) {
+  function();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; ++i) {
+    function();
+  }
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int frames = (argc > 1) ? atoi(argv[1]) : 200;
+  const int sizes[][2] = {{640, 480}, {1920, 1080}};
+
+  printf("%-10s %12s %12s %12s %12s\n", "size", "pixel loop", "1 thread", "2 threads", "4 threads");
+  for (const auto& size : sizes) {
+    image im = make_image(size[0], size[1], 3);
+    for (int i = 0; i < im.w * im.h * im.c; ++i) {
+      im.data[i] = (rand() % 256) / 255.f;
+    }
+    cv::Mat disp(im.h, im.w, CV_8UC3);
+
+    const double pixelLoop = millisecondsPerFrame([&] { generateImagePixelLoop(im, disp); }, frames);
+    const double oneThread = millisecondsPerFrame([&] { generate_image(im, disp, 1); }, frames);
+    const double twoThreads = millisecondsPerFrame([&] { generate_image(im, disp, 2); }, frames);
+    const double fourThreads = millisecondsPerFrame([&] { generate_image(im, disp, 4); }, frames);
+
+    char name[32];
+    snprintf(name, sizeof(name), "%dx%d", size[0], size[1]);
+    printf("%-10s %9.3f ms %9.3f ms %9.3f ms %9.3f ms\n", name, pixelLoop, oneThread, twoThreads, fourThreads);
+    free_image(im);
+  }
+  return 0;
+}
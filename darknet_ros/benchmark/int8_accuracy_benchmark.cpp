@@ -0,0 +1,250 @@
+/*
+ * int8_accuracy_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Compares the detections of a model run in INT8 with the detections of the
+ *  same model in FP32 on held-out images, and prints recall, precision, box
+ *  overlap, probability differences and forward pass times as JSON.
+ */
+
+// c++
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// yaml-cpp
+#include <yaml-cpp/yaml.h>
+
+// OpenCv
+#include <opencv2/highgui/highgui.hpp>
+
+// Image interface.
+#include "darknet_ros/image_interface.hpp"
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+// Post-processing of the decoded detections.
+#include "darknet_ros/box_postprocessing.hpp"
+
+// Reused memory of the decoded detections.
+#include "darknet_ros/detection_arena.hpp"
+
+// Batch normalization folding.
+#include "darknet_ros/batchnorm_folding.hpp"
+
+// INT8 convolutions.
+#include "darknet_ros/int8_inference.hpp"
+
+// Precompiled networks.
+#include "darknet_ros/network_blob.hpp"
+
+#ifndef DARKNET_ROS_SOURCE_DIR
+#error Source directory of darknet_ros is not defined in CMakeLists.txt.
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using darknet_ros::RosBox_;
+
+// Boxes of the same class overlapping at least this much are the same detection.
+const float kMatchIou = 0.5;
+
+struct Options {
+  std::string config;
+  std::string calibrationDir;
+  std::string imageDir;
+  std::string networkDir = std::string(DARKNET_ROS_SOURCE_DIR) + "/yolo_network_config";
+  std::string output;
+};
+
+struct Comparison {
+  int images = 0;
+  long fp32Boxes = 0;
+  long int8Boxes = 0;
+  long matched = 0;
+  double iouSum = 0;
+  double probDifferenceSum = 0;
+  double maxProbDifference = 0;
+  double fp32Ms = 0;
+  double int8Ms = 0;
+};
+
+void printUsage(const char* program) {
+  std::cerr << "Usage: " << program << " --config <yaml> --calibration <dir> --images <dir> [--network-dir <dir>] [--output <json file>]\n\n"
+            << "The calibration images and the held-out images should not overlap.\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) return false;
+    const std::string value = argv[++i];
+    if (arg == "--config") {
+      options.config = value;
+    } else if (arg == "--calibration") {
+      options.calibrationDir = value;
+    } else if (arg == "--images") {
+      options.imageDir = value;
+    } else if (arg == "--network-dir") {
+      options.networkDir = value;
+    } else if (arg == "--output") {
+      options.output = value;
+    } else {
+      return false;
+    }
+  }
+  return !options.config.empty() && !options.calibrationDir.empty() && !options.imageDir.empty();
+}
+
+float iou(const RosBox_& a, const RosBox_& b) {
+  const float w = std::min(a.x + a.w / 2, b.x + b.w / 2) - std::max(a.x - a.w / 2, b.x - b.w / 2);
+  const float h = std::min(a.y + a.h / 2, b.y + b.h / 2) - std::max(a.y - a.h / 2, b.y - b.h / 2);
+  if (w <= 0 || h <= 0) return 0;
+  const float intersection = w * h;
+  return intersection / (a.w * a.h + b.w * b.h - intersection);
+}
+
+// Forward pass, NMS and box extraction as in YoloObjectDetector.
+std::vector<RosBox_> detect(network* net, const image& input, const cv::Mat& frame, float thresh, int classes, double& predictMs) {
+  const Clock::time_point start = Clock::now();
+  network_predict(net, input.data);
+  predictMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  darknet_ros::DetectionArena arena;
+  arena.resize(net, 1);
+  const int nboxes = darknet_ros::getBatchBoxes(net, 0, frame.cols, frame.rows, thresh, .5, arena.detections());
+  darknet_ros::BoxPostprocessor postprocessor;
+  postprocessor.run(arena.detections(), nboxes, classes, thresh, .4);
+  std::vector<RosBox_> boxes(arena.capacity() + 1);
+  boxes.resize(postprocessor.extract(boxes.data(), boxes.size()));
+  return boxes;
+}
+
+// Matches each FP32 box greedily, most probable first, to the unmatched INT8
+// box of its class it overlaps most.
+void compare(std::vector<RosBox_> reference, const std::vector<RosBox_>& quantized, Comparison& comparison) {
+  std::sort(reference.begin(), reference.end(), [](const RosBox_& a, const RosBox_& b) { return a.prob > b.prob; });
+  std::vector<bool> used(quantized.size(), false);
+  for (const RosBox_& box : reference) {
+    int best = -1;
+    float bestIou = kMatchIou;
+    for (size_t j = 0; j < quantized.size(); ++j) {
+      if (used[j] || quantized[j].Class != box.Class) continue;
+      const float overlap = iou(box, quantized[j]);
+      if (overlap >= bestIou) {
+        best = j;
+        bestIou = overlap;
+      }
+    }
+    if (best < 0) continue;
+    used[best] = true;
+    const double difference = std::fabs(box.prob - quantized[best].prob);
+    ++comparison.matched;
+    comparison.iouSum += bestIou;
+    comparison.probDifferenceSum += difference;
+    comparison.maxProbDifference = std::max(comparison.maxProbDifference, difference);
+  }
+  comparison.fp32Boxes += reference.size();
+  comparison.int8Boxes += quantized.size();
+}
+
+void writeJson(std::ostream& out, const std::string& networkName, int layers, const Comparison& c) {
+  const auto ratio = [](double numerator, double denominator) { return denominator > 0 ? numerator / denominator : 1.; };
+  out << "{\n  \"network\": \"" << networkName << "\",\n  \"kernel\": \"" << darknet_ros::int8KernelName() << "\",\n  \"int8_layers\": " << layers
+      << ",\n  \"images\": " << c.images << ",\n  \"fp32_detections\": " << c.fp32Boxes << ",\n  \"int8_detections\": " << c.int8Boxes
+      << ",\n  \"matched\": " << c.matched << ",\n  \"recall\": " << ratio(c.matched, c.fp32Boxes)
+      << ",\n  \"precision\": " << ratio(c.matched, c.int8Boxes) << ",\n  \"mean_iou\": " << (c.matched ? c.iouSum / c.matched : 0)
+      << ",\n  \"mean_prob_difference\": " << (c.matched ? c.probDifferenceSum / c.matched : 0)
+      << ",\n  \"max_prob_difference\": " << c.maxProbDifference << ",\n  \"fp32_predict_ms\": " << ratio(c.fp32Ms, c.images)
+      << ",\n  \"int8_predict_ms\": " << ratio(c.int8Ms, c.images) << ",\n  \"speedup\": " << ratio(c.fp32Ms, c.int8Ms) << "\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  YAML::Node model;
+  try {
+    model = YAML::LoadFile(options.config)["yolo_model"];
+  } catch (const YAML::Exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  if (!model) {
+    std::cerr << options.config << " is no model config.\n";
+    return 1;
+  }
+  const std::string networkName = model["config_file"]["name"].as<std::string>();
+  std::string cfgPath = options.networkDir + "/cfg/" + networkName;
+  std::string weightsPath = options.networkDir + "/weights/" + model["weight_file"]["name"].as<std::string>();
+  const float thresh = model["threshold"] ? model["threshold"]["value"].as<float>() : 0.3f;
+  const int classes = model["detection_classes"]["names"].size();
+  if (access(cfgPath.c_str(), R_OK) != 0 || access(weightsPath.c_str(), R_OK) != 0) {
+    std::cerr << "Missing " << cfgPath << " or " << weightsPath << ".\n";
+    return 1;
+  }
+  const std::vector<std::string> images = darknet_ros::listImages(options.imageDir);
+  if (images.empty()) {
+    std::cerr << "No images found in " << options.imageDir << ".\n";
+    return 1;
+  }
+
+  std::vector<char> cfg(cfgPath.begin(), cfgPath.end());
+  std::vector<char> weights(weightsPath.begin(), weightsPath.end());
+  cfg.push_back(0);
+  weights.push_back(0);
+  network* fp32 = darknet_ros::loadNetworkWithBatch(cfg.data(), weights.data(), 1);
+  network* int8 = darknet_ros::loadNetworkWithBatch(cfg.data(), weights.data(), 1);
+  // Both folded as in YoloObjectDetector, so only the quantization differs.
+  darknet_ros::foldBatchNorm(fp32);
+  darknet_ros::foldBatchNorm(int8);
+  std::string error;
+  const int layers = darknet_ros::quantizeNetwork(int8, darknet_ros::listImages(options.calibrationDir), error);
+  if (layers < 0) {
+    std::cerr << "Could not calibrate on " << options.calibrationDir << ": " << error << "\n";
+    return 1;
+  }
+
+  const int channelSwap = !mat_to_image_swaps_rb();
+  letterbox_plan plan = make_letterbox_plan();
+  image input = make_image(fp32->w, fp32->h, fp32->c);
+  Comparison comparison;
+  for (const std::string& path : images) {
+    const cv::Mat frame = cv::imread(path, cv::IMREAD_COLOR);
+    if (frame.empty()) continue;
+    letterbox_mat_into(frame, channelSwap, input, &plan);
+    const std::vector<RosBox_> reference = detect(fp32, input, frame, thresh, classes, comparison.fp32Ms);
+    const std::vector<RosBox_> quantized = detect(int8, input, frame, thresh, classes, comparison.int8Ms);
+    compare(reference, quantized, comparison);
+    ++comparison.images;
+  }
+
+  if (options.output.empty()) {
+    writeJson(std::cout, networkName, layers, comparison);
+  } else {
+    std::ofstream out(options.output.c_str());
+    writeJson(out, networkName, layers, comparison);
+  }
+
+  free_image(input);
+  free_letterbox_plan(&plan);
+  darknet_ros::releaseQuantizedNetwork(int8);
+  darknet_ros::freeNetwork(int8);
+  darknet_ros::freeNetwork(fp32);
+  return 0;
+}
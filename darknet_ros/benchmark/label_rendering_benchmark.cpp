@@ -0,0 +1,95 @@
+/*
+ * label_rendering_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Startup time, resident memory and per-label cost of drawing label text
+ *  from darknet's PNG alphabet and from the glyph atlases.
+ */
+
+// c++
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+// Image interface.
+#include "darknet_ros/image_interface.hpp"
+
+#ifndef DARKNET_FILE_PATH
+#error Path of darknet repository is not defined in CMakeLists.txt.
+#endif
+
+namespace {
+
+// Resident set size of the process [MB].
+double residentMegabytes() {
+  long pages = 0;
+  long resident = 0;
+  std::ifstream statm("/proc/self/statm");
+  statm >> pages >> resident;
+  return resident * sysconf(_SC_PAGESIZE) / (1024. * 1024.);
+}
+
+double millisecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Function>
+double microsecondsPerLabel(Function function, int labels) {
+  function();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < labels; ++i) {
+    function();
+  }
+  return 1000 * millisecondsSince(start) / labels;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int labels = (argc > 1) ? atoi(argv[1]) : 2000;
+  char text[] = "person, bicycle";
+  const float rgb[3] = {1.f, .5f, 0.f};
+  image im = make_image(1920, 1080, 3);
+  const int size = (int)(im.h * .03) / 10;
+
+  // The atlases go first, so the alphabet's memory is not reused for them.
+  double rss = residentMegabytes();
+  auto start = std::chrono::steady_clock::now();
+  size_t atlasBytes = load_glyph_atlas(size);
+  const double atlasTime = millisecondsSince(start);
+  for (int s = 0; s < LABEL_SIZES; ++s) {
+    if (s != size) atlasBytes += load_glyph_atlas(s);
+  }
+  const double atlasRss = residentMegabytes() - rss;
+
+  // load_alphabet reads data/labels relative to the working directory.
+  if (chdir(DARKNET_FILE_PATH) != 0) {
+    fprintf(stderr, "Cannot change to %s.\n", DARKNET_FILE_PATH);
+    return 1;
+  }
+  rss = residentMegabytes();
+  start = std::chrono::steady_clock::now();
+  image** alphabet = load_alphabet();
+  const double alphabetTime = millisecondsSince(start);
+  const double alphabetRss = residentMegabytes() - rss;
+
+  const double alphabetLabel = microsecondsPerLabel(
+      [&] {
+        image label = get_label(alphabet, text, im.h * .03);
+        draw_label(im, 500, 500, label, rgb);
+        free_image(label);
+      },
+      labels);
+  const double atlasLabel = microsecondsPerLabel([&] { draw_label_text(im, 500, 500, text, rgb, size); }, labels);
+
+  printf("%-14s %14s %14s %14s\n", "", "startup", "resident", "per label");
+  printf("%-14s %11.1f ms %11.1f MB %11.1f us\n", "PNG alphabet", alphabetTime, alphabetRss, alphabetLabel);
+  printf("%-14s %11.1f ms %11.1f MB %11.1f us\n", "glyph atlas", atlasTime, atlasRss, atlasLabel);
+  printf("\nThe atlas startup is the first label of a 1080p image, all %d atlases take %zu kB.\n", LABEL_SIZES, atlasBytes / 1024);
+  free_image(im);
+  return 0;
+}
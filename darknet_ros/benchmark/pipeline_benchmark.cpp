@@ -0,0 +1,356 @@
+/*
+ * pipeline_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Runs the detection pipeline of YoloObjectDetector (letterbox, forward
+ *  pass, NMS, box extraction and depth association) over a directory of
+ *  images without ROS, for every model config, and prints throughput and
+ *  per stage latency percentiles as JSON.
+ */
+
+// c++
+#include <dirent.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// yaml-cpp
+#include <yaml-cpp/yaml.h>
+
+// OpenCv
+#include <opencv2/highgui/highgui.hpp>
+
+// Image interface.
+#include "darknet_ros/image_interface.hpp"
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+// Post-processing of the decoded detections.
+#include "darknet_ros/box_postprocessing.hpp"
+
+// Reused memory of the decoded detections.
+#include "darknet_ros/detection_arena.hpp"
+
+// Batch normalization folding.
+#include "darknet_ros/batchnorm_folding.hpp"
+
+#ifndef DARKNET_ROS_SOURCE_DIR
+#error Source directory of darknet_ros is not defined in CMakeLists.txt.
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kStageNames[] = {"preprocess", "predict", "nms", "extract", "depth", "total"};
+enum Stage { PREPROCESS, PREDICT, NMS, EXTRACT, DEPTH, TOTAL, NUM_STAGES };
+
+struct Options {
+  std::string imageDir;
+  std::string depthDir;
+  std::vector<std::string> configs;
+  std::string networkDir = std::string(DARKNET_ROS_SOURCE_DIR) + "/yolo_network_config";
+  std::string output;
+  int iterations = 1;
+  int warmup = 1;
+};
+
+struct Frame {
+  std::string name;
+  cv::Mat image;
+  cv::Mat depth;
+};
+
+// Result of one model config.
+struct ConfigResult {
+  std::string config;
+  std::string error;
+  std::string network;
+  int frames = 0;
+  long detections = 0;
+  std::vector<double> stageTimes[NUM_STAGES];  // [ms]
+};
+
+void printUsage(const char* program) {
+  std::cerr << "Usage: " << program << " --images <dir> [--depth <dir>] [--config <yaml>]... [--network-dir <dir>]\n"
+            << "       [--iterations <n>] [--warmup <n>] [--output <json file>]\n\n"
+            << "Without --config, every model config in " << DARKNET_ROS_SOURCE_DIR << "/config is run. Depth images are\n"
+            << "16 bit PNGs in mm named like the image they belong to.\n";
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+  return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string baseName(const std::string& path) {
+  const size_t slash = path.rfind('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+std::string stem(const std::string& name) {
+  const size_t dot = name.rfind('.');
+  return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+// Sorted names of the files in dir with one of the given extensions.
+std::vector<std::string> listFiles(const std::string& dir, const std::vector<std::string>& extensions) {
+  std::vector<std::string> files;
+  DIR* handle = opendir(dir.c_str());
+  if (!handle) return files;
+  while (dirent* entry = readdir(handle)) {
+    std::string name = entry->d_name;
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    for (const std::string& extension : extensions) {
+      if (endsWith(lower, extension)) {
+        files.push_back(name);
+        break;
+      }
+    }
+  }
+  closedir(handle);
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) return false;
+    const std::string value = argv[++i];
+    if (arg == "--images") {
+      options.imageDir = value;
+    } else if (arg == "--depth") {
+      options.depthDir = value;
+    } else if (arg == "--config") {
+      options.configs.push_back(value);
+    } else if (arg == "--network-dir") {
+      options.networkDir = value;
+    } else if (arg == "--iterations") {
+      options.iterations = std::max(1, atoi(value.c_str()));
+    } else if (arg == "--warmup") {
+      options.warmup = std::max(0, atoi(value.c_str()));
+    } else if (arg == "--output") {
+      options.output = value;
+    } else {
+      return false;
+    }
+  }
+  if (options.configs.empty()) {
+    const std::string configDir = std::string(DARKNET_ROS_SOURCE_DIR) + "/config";
+    for (const std::string& name : listFiles(configDir, {".yaml"})) {
+      options.configs.push_back(configDir + "/" + name);
+    }
+  }
+  return !options.imageDir.empty();
+}
+
+std::vector<Frame> loadFrames(const Options& options) {
+  std::vector<Frame> frames;
+  for (const std::string& path : darknet_ros::listImages(options.imageDir)) {
+    const std::string name = baseName(path);
+    Frame frame;
+    frame.name = name;
+    frame.image = cv::imread(path, cv::IMREAD_COLOR);
+    if (frame.image.empty()) {
+      std::cerr << "Skipping " << name << ", it could not be read.\n";
+      continue;
+    }
+    if (!options.depthDir.empty()) {
+      const std::string depthPath = options.depthDir + "/" + stem(name) + ".png";
+      if (access(depthPath.c_str(), R_OK) == 0) {
+        frame.depth = cv::imread(depthPath, cv::IMREAD_ANYDEPTH);
+        if (frame.depth.type() != CV_16UC1 || frame.depth.size() != frame.image.size()) {
+          std::cerr << "Ignoring " << depthPath << ", it is no 16 bit image of the size of " << name << ".\n";
+          frame.depth = cv::Mat();
+        }
+      }
+    }
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+double elapsedMs(Clock::time_point& start) {
+  const Clock::time_point now = Clock::now();
+  const double elapsed = std::chrono::duration<double, std::milli>(now - start).count();
+  start = now;
+  return elapsed;
+}
+
+void runConfig(const Options& options, const std::vector<Frame>& frames, ConfigResult& result) {
+  YAML::Node model;
+  try {
+    model = YAML::LoadFile(result.config)["yolo_model"];
+  } catch (const YAML::Exception& e) {
+    result.error = e.what();
+    return;
+  }
+  if (!model) {
+    result.error = "no yolo_model";
+    return;
+  }
+  result.network = model["config_file"]["name"].as<std::string>();
+  const std::string weightsName = model["weight_file"]["name"].as<std::string>();
+  const float thresh = model["threshold"] ? model["threshold"]["value"].as<float>() : 0.3f;
+  const int classes = model["detection_classes"]["names"].size();
+
+  std::string cfgPath = options.networkDir + "/cfg/" + result.network;
+  std::string weightsPath = options.networkDir + "/weights/" + weightsName;
+  if (access(cfgPath.c_str(), R_OK) != 0 || access(weightsPath.c_str(), R_OK) != 0) {
+    result.error = "missing " + cfgPath + " or " + weightsPath;
+    return;
+  }
+
+  std::vector<char> cfg(cfgPath.begin(), cfgPath.end());
+  std::vector<char> weights(weightsPath.begin(), weightsPath.end());
+  cfg.push_back(0);
+  weights.push_back(0);
+  network* net = darknet_ros::loadNetworkWithBatch(cfg.data(), weights.data(), 1);
+
+  // Same network, buffers and settings as YoloObjectDetector.
+  darknet_ros::foldBatchNorm(net);
+  const float nms = .4;
+  const float hier = .5;
+  const int channelSwap = !mat_to_image_swaps_rb();
+  letterbox_plan plan = make_letterbox_plan();
+  image input = make_image(net->w, net->h, net->c);
+  darknet_ros::DetectionArena arena;
+  arena.resize(net, 1);
+  std::vector<darknet_ros::RosBox_> boxes(arena.capacity() + 1);
+  darknet_ros::BoxPostprocessor postprocessor;
+  const darknet_ros::DepthIntrinsics_ intrinsics = {0, 0, 1, 1};
+
+  for (int iteration = -options.warmup; iteration < options.iterations; ++iteration) {
+    for (const Frame& frame : frames) {
+      double times[NUM_STAGES];
+      const Clock::time_point frameStart = Clock::now();
+      Clock::time_point start = frameStart;
+
+      letterbox_mat_into(frame.image, channelSwap, input, &plan);
+      times[PREPROCESS] = elapsedMs(start);
+
+      network_predict(net, input.data);
+      times[PREDICT] = elapsedMs(start);
+
+      const int nboxes = darknet_ros::getBatchBoxes(net, 0, frame.image.cols, frame.image.rows, thresh, hier, arena.detections());
+      postprocessor.run(arena.detections(), nboxes, classes, thresh, nms);
+      times[NMS] = elapsedMs(start);
+
+      const int count = postprocessor.extract(boxes.data(), boxes.size());
+      times[EXTRACT] = elapsedMs(start);
+
+      for (int i = 0; i < count; ++i) {
+        const int u = boxes[i].x * frame.image.cols;
+        const int v = boxes[i].y * frame.image.rows;
+        volatile float z = darknet_ros::backProject(frame.depth, intrinsics, u, v).z;
+        (void)z;
+      }
+      times[DEPTH] = elapsedMs(start);
+      times[TOTAL] = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+
+      if (iteration < 0) continue;
+      for (int stage = 0; stage < NUM_STAGES; ++stage) {
+        result.stageTimes[stage].push_back(times[stage]);
+      }
+      result.detections += count;
+      ++result.frames;
+    }
+  }
+
+  free_image(input);
+  free_letterbox_plan(&plan);
+  free_network(net);
+}
+
+// Nearest rank percentile of sorted values.
+double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  const size_t rank = std::ceil(p / 100. * sorted.size());
+  return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+std::string jsonString(const std::string& text) {
+  std::string quoted = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') quoted += '\\';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+void writeJson(std::ostream& out, const Options& options, size_t numImages, std::vector<ConfigResult>& results) {
+  out << "{\n  \"images\": " << numImages << ",\n  \"iterations\": " << options.iterations << ",\n  \"configs\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    ConfigResult& result = results[i];
+    out << (i ? "," : "") << "\n    {\n      \"config\": " << jsonString(baseName(result.config));
+    if (!result.error.empty()) {
+      out << ",\n      \"error\": " << jsonString(result.error) << "\n    }";
+      continue;
+    }
+    double totalMs = 0;
+    for (double time : result.stageTimes[TOTAL]) totalMs += time;
+    out << ",\n      \"network\": " << jsonString(result.network) << ",\n      \"frames\": " << result.frames
+        << ",\n      \"detections\": " << result.detections
+        << ",\n      \"throughput_fps\": " << (totalMs > 0 ? 1000. * result.frames / totalMs : 0) << ",\n      \"stages_ms\": {";
+    for (int stage = 0; stage < NUM_STAGES; ++stage) {
+      std::vector<double>& times = result.stageTimes[stage];
+      std::sort(times.begin(), times.end());
+      double sum = 0;
+      for (double time : times) sum += time;
+      out << (stage ? "," : "") << "\n        " << jsonString(kStageNames[stage]) << ": {\"mean\": " << (times.empty() ? 0 : sum / times.size())
+          << ", \"p50\": " << percentile(times, 50) << ", \"p95\": " << percentile(times, 95) << ", \"p99\": " << percentile(times, 99)
+          << "}";
+    }
+    out << "\n      }\n    }";
+  }
+  out << "\n  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  const std::vector<Frame> frames = loadFrames(options);
+  if (frames.empty()) {
+    std::cerr << "No images found in " << options.imageDir << ".\n";
+    return 1;
+  }
+
+  std::vector<ConfigResult> results;
+  for (const std::string& config : options.configs) {
+    ConfigResult result;
+    result.config = config;
+    runConfig(options, frames, result);
+    if (result.error == "no yolo_model") continue;  // not a model config, e.g. ros.yaml
+    if (!result.error.empty()) {
+      std::cerr << "Skipping " << config << ": " << result.error << "\n";
+    }
+    results.push_back(result);
+  }
+
+  if (options.output.empty()) {
+    writeJson(std::cout, options, frames.size(), results);
+  } else {
+    std::ofstream out(options.output.c_str());
+    writeJson(out, options, frames.size(), results);
+  }
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * postprocessing_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Non-maximum suppression and box extraction of a dense synthetic scene with
+ *  darknet's do_nms_obj and do_nms_sort followed by extractBoxes, and with the
+ *  BoxPostprocessor of the detect thread.
+ */
+
+// c++
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Post-processing of the decoded detections.
+#include "darknet_ros/box_postprocessing.hpp"
+
+namespace {
+
+double millisecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Boxes clustered around objects, like the output of a crowded frame after
+// get_network_boxes: class probabilities not above thresh are zero.
+void makeScene(int nboxes, int classes, float thresh, std::vector<detection>& dets, std::vector<float>& probs) {
+  const int objects = nboxes / 20 + 1;
+  dets.assign(nboxes, detection());
+  probs.assign(nboxes * classes, 0.f);
+  for (int i = 0; i < nboxes; ++i) {
+    const int object = rand() % objects;
+    detection& det = dets[i];
+    det.bbox.x = (object % 16 + .5f) / 16 + .02f * rand() / RAND_MAX;
+    det.bbox.y = (object / 16 % 16 + .5f) / 16 + .02f * rand() / RAND_MAX;
+    det.bbox.w = .03f + .05f * rand() / RAND_MAX;
+    det.bbox.h = .03f + .05f * rand() / RAND_MAX;
+    det.classes = classes;
+    det.objectness = static_cast<float>(rand()) / RAND_MAX;
+    det.prob = &probs[i * classes];
+    det.sort_class = 0;
+    for (int j = 0; j < 3; ++j) {
+      const float prob = det.objectness * rand() / RAND_MAX;
+      if (prob > thresh) det.prob[(object + j) % classes] = prob;
+    }
+  }
+}
+
+// Milliseconds per frame of the post-processing, without copying the scene.
+template <typename Function>
+double millisecondsPerFrame(const std::vector<detection>& scene, const std::vector<float>& sceneProbs, int classes,
+                            int iterations, Function function) {
+  std::vector<detection> dets;
+  std::vector<float> probs;
+  double total = 0;
+  for (int i = 0; i < iterations; ++i) {
+    dets = scene;
+    probs = sceneProbs;
+    for (size_t d = 0; d < dets.size(); ++d) dets[d].prob = &probs[d * classes];
+    const auto start = std::chrono::steady_clock::now();
+    function(dets.data(), dets.size());
+    total += millisecondsSince(start);
+  }
+  return total / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int nboxes = (argc > 1) ? atoi(argv[1]) : 10647;
+  const int classes = (argc > 2) ? atoi(argv[2]) : 80;
+  const int iterations = (argc > 3) ? atoi(argv[3]) : 50;
+  const float thresh = .3f;
+  const float nms = .4f;
+  srand(1);
+  std::vector<detection> scene;
+  std::vector<float> probs;
+  makeScene(nboxes, classes, thresh, scene, probs);
+
+  std::vector<darknet_ros::RosBox_> roiBoxes(nboxes * classes + 1);
+  int count = 0;
+  const double objTime = millisecondsPerFrame(scene, probs, classes, iterations, [&](detection* dets, int n) {
+    do_nms_obj(dets, n, classes, nms);
+    count = darknet_ros::extractBoxes(dets, n, classes, roiBoxes.data());
+  });
+  const int objCount = count;
+  const double sortTime = millisecondsPerFrame(scene, probs, classes, iterations, [&](detection* dets, int n) {
+    do_nms_sort(dets, n, classes, nms);
+    count = darknet_ros::extractBoxes(dets, n, classes, roiBoxes.data());
+  });
+  const int sortCount = count;
+  darknet_ros::BoxPostprocessor postprocessor;
+  const double postprocessorTime = millisecondsPerFrame(scene, probs, classes, iterations, [&](detection* dets, int n) {
+    postprocessor.run(dets, n, classes, thresh, nms);
+    count = postprocessor.extract(roiBoxes.data(), roiBoxes.size());
+  });
+
+  printf("%d boxes, %d classes, %d iterations\n", nboxes, classes, iterations);
+  printf("%-26s %14s %10s\n", "", "per frame", "boxes");
+  printf("%-26s %11.3f ms %10d\n", "do_nms_obj + extractBoxes", objTime, objCount);
+  printf("%-26s %11.3f ms %10d\n", "do_nms_sort + extractBoxes", sortTime, sortCount);
+  printf("%-26s %11.3f ms %10d\n", "BoxPostprocessor", postprocessorTime, count);
+  return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * publish_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Message building of the publish stage for crowded frames: the per-class
+ *  lists and copied depth message the node used before, against the single
+ *  pass into messages that are reused.
+ */
+
+// c++
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// darknet_ros_msgs
+#include <darknet_ros_msgs/BoundingBoxes.h>
+#include <darknet_ros_msgs/FrameDepth.h>
+
+// Messages of the publish stage.
+#include "darknet_ros/box_messages.hpp"
+
+using darknet_ros::RosBox_;
+
+namespace {
+
+const int kWidth = 1280;
+const int kHeight = 720;
+
+double microsecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Depth of a box as YoloObjectDetector::associateDepth writes it.
+void associateDepth(const cv::Mat& depth, const darknet_ros_msgs::BoundingBox& bbox, darknet_ros_msgs::ObjDepth& objDepth) {
+  const int u = static_cast<int>((bbox.xmin + bbox.xmax) / 2);
+  const int v = static_cast<int>((bbox.ymin + bbox.ymax) / 2);
+  const darknet_ros::DepthIntrinsics_ intrinsics = {kWidth / 2.f, kHeight / 2.f, 600, 600};
+  const cv::Point3f position = darknet_ros::backProject(depth, intrinsics, u, v);
+  objDepth.objID = bbox.id;
+  objDepth.className = bbox.Class;
+  objDepth.classType = "To be decided";
+  objDepth.objDepth = round(position.z * 1000.0) / 1000.0;
+  objDepth.objX = round(position.x * 1000.0) / 1000.0;
+  objDepth.objY = round(position.y * 1000.0) / 1000.0;
+  objDepth.bbox_center_u = u;
+  objDepth.bbox_center_v = v;
+}
+
+// The boxes grouped by class through per-class lists, the messages built
+// with push_back and the depth message copied for the depth image.
+void perClassLists(const std::vector<RosBox_>& boxes, const std::vector<std::string>& labels, const cv::Mat& depth,
+                   std::vector<std::vector<RosBox_>>& rosBoxes, darknet_ros_msgs::BoundingBoxes& boundingBoxes,
+                   darknet_ros_msgs::FrameDepth& frameDepth, size_t& objects) {
+  for (const RosBox_& box : boxes) {
+    for (size_t j = 0; j < labels.size(); ++j) {
+      if (box.Class == static_cast<int>(j)) rosBoxes[j].push_back(box);
+    }
+  }
+  for (size_t i = 0; i < labels.size(); ++i) {
+    for (const RosBox_& box : rosBoxes[i]) {
+      darknet_ros_msgs::BoundingBox boundingBox;
+      boundingBox.Class = labels[i];
+      boundingBox.id = i;
+      boundingBox.probability = box.prob;
+      boundingBox.xmin = (box.x - box.w / 2) * kWidth;
+      boundingBox.ymin = (box.y - box.h / 2) * kHeight;
+      boundingBox.xmax = (box.x + box.w / 2) * kWidth;
+      boundingBox.ymax = (box.y + box.h / 2) * kHeight;
+      boundingBoxes.bounding_boxes.push_back(boundingBox);
+    }
+    rosBoxes[i].clear();
+  }
+  darknet_ros_msgs::ObjDepth objDepth;
+  for (const darknet_ros_msgs::BoundingBox& boundingBox : boundingBoxes.bounding_boxes) {
+    associateDepth(depth, boundingBox, objDepth);
+    frameDepth.objDepths.push_back(objDepth);
+  }
+  const darknet_ros_msgs::FrameDepth copy(frameDepth);
+  objects += copy.objDepths.size();
+  frameDepth.objDepths.clear();
+  boundingBoxes.bounding_boxes.clear();
+}
+
+// The single pass of the node into reused messages.
+void singlePass(const std::vector<RosBox_>& boxes, const std::vector<std::string>& labels, const cv::Mat& depth,
+                darknet_ros_msgs::BoundingBoxesPtr& boundingBoxesMessage, darknet_ros_msgs::FrameDepthPtr& frameDepthMessage,
+                size_t& objects) {
+  darknet_ros_msgs::BoundingBoxesPtr& boundingBoxes = darknet_ros::recycleMessage(boundingBoxesMessage);
+  const int num = darknet_ros::fillBoundingBoxes(boxes.data(), boxes.size(), kWidth, kHeight, labels, false, boundingBoxes->bounding_boxes);
+  darknet_ros_msgs::FrameDepthPtr& frameDepth = darknet_ros::recycleMessage(frameDepthMessage);
+  frameDepth->objDepths.resize(num);
+  for (int i = 0; i < num; ++i) associateDepth(depth, boundingBoxes->bounding_boxes[i], frameDepth->objDepths[i]);
+  objects += frameDepth->objDepths.size();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int count = (argc > 1) ? atoi(argv[1]) : 800;
+  const int classes = (argc > 2) ? atoi(argv[2]) : 80;
+  const int iterations = (argc > 3) ? atoi(argv[3]) : 2000;
+
+  std::vector<std::string> labels;
+  for (int j = 0; j < classes; ++j) labels.push_back("class_" + std::to_string(j));
+  srand(1);
+  std::vector<RosBox_> boxes(count);
+  for (RosBox_& box : boxes) {
+    box.x = static_cast<float>(rand()) / RAND_MAX;
+    box.y = static_cast<float>(rand()) / RAND_MAX;
+    box.w = .05f;
+    box.h = .1f;
+    box.prob = .5f;
+    box.Class = rand() % classes;
+    box.id = 0;
+  }
+  const cv::Mat depth(kHeight, kWidth, CV_16UC1, cv::Scalar(1500));
+
+  std::vector<std::vector<RosBox_>> rosBoxes(classes);
+  darknet_ros_msgs::BoundingBoxes boundingBoxes;
+  darknet_ros_msgs::FrameDepth frameDepth;
+  size_t objects = 0;
+  perClassLists(boxes, labels, depth, rosBoxes, boundingBoxes, frameDepth, objects);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) perClassLists(boxes, labels, depth, rosBoxes, boundingBoxes, frameDepth, objects);
+  const double perClassTime = microsecondsSince(start) / iterations;
+
+  darknet_ros_msgs::BoundingBoxesPtr boundingBoxesMessage;
+  darknet_ros_msgs::FrameDepthPtr frameDepthMessage;
+  singlePass(boxes, labels, depth, boundingBoxesMessage, frameDepthMessage, objects);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) singlePass(boxes, labels, depth, boundingBoxesMessage, frameDepthMessage, objects);
+  const double singlePassTime = microsecondsSince(start) / iterations;
+
+  printf("%d boxes, %d classes, %d iterations, %zu objects\n", count, classes, iterations, objects);
+  printf("%-16s %14s\n", "", "per frame");
+  printf("%-16s %11.1f us\n", "per-class lists", perClassTime);
+  printf("%-16s %11.1f us\n", "single pass", singlePassTime);
+  return 0;
+}
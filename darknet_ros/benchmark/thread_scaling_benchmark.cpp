@@ -0,0 +1,180 @@
+/*
+ * thread_scaling_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Times the forward pass of a model as YoloObjectDetector runs it, with 1 to
+ *  N inference threads, and prints the latency and speedup of each thread
+ *  count as JSON.
+ */
+
+// c++
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// yaml-cpp
+#include <yaml-cpp/yaml.h>
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+// Batch normalization folding.
+#include "darknet_ros/batchnorm_folding.hpp"
+
+// Inference threads.
+#include "darknet_ros/inference_threads.hpp"
+
+// Precompiled networks.
+#include "darknet_ros/network_blob.hpp"
+
+#ifndef DARKNET_ROS_SOURCE_DIR
+#error Source directory of darknet_ros is not defined in CMakeLists.txt.
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::string config = std::string(DARKNET_ROS_SOURCE_DIR) + "/config/yolov2-tiny.yaml";
+  std::string networkDir = std::string(DARKNET_ROS_SOURCE_DIR) + "/yolo_network_config";
+  std::string output;
+  std::vector<int> cpus;
+  int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  int iterations = 20;
+  int warmup = 2;
+};
+
+struct ThreadResult {
+  int threads;
+  double mean;
+  double p50;
+  double p95;
+};
+
+void printUsage(const char* program) {
+  std::cerr << "Usage: " << program << " [--config <yaml>] [--network-dir <dir>] [--max-threads <n>] [--cpus <list>]\n"
+            << "       [--iterations <n>] [--warmup <n>] [--output <json file>]\n\n"
+            << "--cpus pins the threads like inference/cpus, for example --cpus 2,3,4,5.\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) return false;
+    const std::string value = argv[++i];
+    if (arg == "--config") {
+      options.config = value;
+    } else if (arg == "--network-dir") {
+      options.networkDir = value;
+    } else if (arg == "--max-threads") {
+      options.maxThreads = std::max(1, atoi(value.c_str()));
+    } else if (arg == "--cpus") {
+      std::istringstream list(value);
+      std::string cpu;
+      while (std::getline(list, cpu, ',')) options.cpus.push_back(atoi(cpu.c_str()));
+    } else if (arg == "--iterations") {
+      options.iterations = std::max(1, atoi(value.c_str()));
+    } else if (arg == "--warmup") {
+      options.warmup = std::max(0, atoi(value.c_str()));
+    } else if (arg == "--output") {
+      options.output = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Nearest rank percentile of sorted values.
+double percentile(const std::vector<double>& sorted, double p) {
+  const size_t rank = std::ceil(p / 100. * sorted.size());
+  return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+void writeJson(std::ostream& out, const std::string& networkName, const Options& options, const std::vector<ThreadResult>& results) {
+  out << "{\n  \"network\": \"" << networkName << "\",\n  \"iterations\": " << options.iterations << ",\n  \"pinned\": "
+      << (options.cpus.empty() ? "false" : "true") << ",\n  \"threads\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const ThreadResult& result = results[i];
+    out << (i ? "," : "") << "\n    {\"threads\": " << result.threads << ", \"mean_ms\": " << result.mean << ", \"p50_ms\": " << result.p50
+        << ", \"p95_ms\": " << result.p95 << ", \"speedup\": " << results[0].mean / result.mean
+        << ", \"efficiency\": " << results[0].mean / result.mean / result.threads << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  YAML::Node model;
+  try {
+    model = YAML::LoadFile(options.config)["yolo_model"];
+  } catch (const YAML::Exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  if (!model) {
+    std::cerr << options.config << " is no model config.\n";
+    return 1;
+  }
+  const std::string networkName = model["config_file"]["name"].as<std::string>();
+  std::string cfgPath = options.networkDir + "/cfg/" + networkName;
+  std::string weightsPath = options.networkDir + "/weights/" + model["weight_file"]["name"].as<std::string>();
+  if (access(cfgPath.c_str(), R_OK) != 0 || access(weightsPath.c_str(), R_OK) != 0) {
+    std::cerr << "Missing " << cfgPath << " or " << weightsPath << ".\n";
+    return 1;
+  }
+
+  std::vector<char> cfg(cfgPath.begin(), cfgPath.end());
+  std::vector<char> weights(weightsPath.begin(), weightsPath.end());
+  cfg.push_back(0);
+  weights.push_back(0);
+  network* net = darknet_ros::loadNetworkWithBatch(cfg.data(), weights.data(), 1);
+  darknet_ros::foldBatchNorm(net);
+  // The content of the image does not change the work of a forward pass.
+  std::vector<float> input(net->inputs, .5f);
+
+  std::vector<ThreadResult> results;
+  for (int threads = 1; threads <= options.maxThreads; ++threads) {
+    darknet_ros::setInferenceThreads(threads, options.cpus);
+    if (!options.cpus.empty()) darknet_ros::pinInferenceThread();
+    std::vector<double> times;
+    for (int iteration = -options.warmup; iteration < options.iterations; ++iteration) {
+      const Clock::time_point start = Clock::now();
+      network_predict(net, input.data());
+      if (iteration >= 0) times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    double sum = 0;
+    for (double time : times) sum += time;
+    results.push_back(ThreadResult{threads, sum / times.size(), percentile(times, 50), percentile(times, 95)});
+    std::cerr << threads << " threads: " << results.back().mean << " ms\n";
+  }
+  darknet_ros::setInferenceThreads(1, std::vector<int>());
+
+  if (options.output.empty()) {
+    writeJson(std::cout, networkName, options, results);
+  } else {
+    std::ofstream out(options.output.c_str());
+    writeJson(out, networkName, options, results);
+  }
+  darknet_ros::freeNetwork(net);
+  return 0;
+}
@@ -0,0 +1,295 @@
+/*
+ * tiling_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Detects a directory of high resolution images letterboxed as a whole and
+ *  in overlapping tiles, as YoloObjectDetector does with tiling/enabled, and
+ *  prints the throughput and recall of both as JSON.
+ */
+
+// c++
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// yaml-cpp
+#include <yaml-cpp/yaml.h>
+
+// OpenCv
+#include <opencv2/highgui/highgui.hpp>
+
+// Image interface.
+#include "darknet_ros/image_interface.hpp"
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+// Post-processing of the decoded detections.
+#include "darknet_ros/box_postprocessing.hpp"
+
+// Reused memory of the decoded detections.
+#include "darknet_ros/detection_arena.hpp"
+
+// Batch normalization folding.
+#include "darknet_ros/batchnorm_folding.hpp"
+
+// Precompiled networks.
+#include "darknet_ros/network_blob.hpp"
+
+#ifndef DARKNET_ROS_SOURCE_DIR
+#error Source directory of darknet_ros is not defined in CMakeLists.txt.
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using darknet_ros::RosBox_;
+
+// Boxes of the same class overlapping at least this much are the same object.
+const float kMatchIou = 0.5;
+
+// Objects smaller than this in the frame are counted as small, as in COCO [pixels].
+const float kSmallArea = 32 * 32;
+
+struct Options {
+  std::string config = std::string(DARKNET_ROS_SOURCE_DIR) + "/config/yolov2-tiny.yaml";
+  std::string imageDir;
+  std::string labelDir;
+  std::string networkDir = std::string(DARKNET_ROS_SOURCE_DIR) + "/yolo_network_config";
+  std::string output;
+  int tileSize = 960;
+  double overlap = .2;
+  bool fullFrame = true;
+};
+
+struct Run {
+  int images = 0;
+  long detections = 0;
+  long matched = 0;
+  long smallMatched = 0;
+  double ms = 0;
+};
+
+void printUsage(const char* program) {
+  std::cerr << "Usage: " << program << " --images <dir> [--labels <dir>] [--config <yaml>] [--network-dir <dir>]\n"
+            << "       [--tile-size <pixels>] [--overlap <fraction>] [--full-frame <0|1>] [--output <json file>]\n\n"
+            << "Labels are darknet label files with the base name of their image. Without labels, the\n"
+            << "detections of the tiles are the reference the letterboxed detections are compared to.\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) return false;
+    const std::string value = argv[++i];
+    if (arg == "--config") {
+      options.config = value;
+    } else if (arg == "--images") {
+      options.imageDir = value;
+    } else if (arg == "--labels") {
+      options.labelDir = value;
+    } else if (arg == "--network-dir") {
+      options.networkDir = value;
+    } else if (arg == "--tile-size") {
+      options.tileSize = std::max(1, atoi(value.c_str()));
+    } else if (arg == "--overlap") {
+      options.overlap = std::min(std::max(atof(value.c_str()), 0.), .9);
+    } else if (arg == "--full-frame") {
+      options.fullFrame = atoi(value.c_str()) != 0;
+    } else if (arg == "--output") {
+      options.output = value;
+    } else {
+      return false;
+    }
+  }
+  return !options.imageDir.empty();
+}
+
+// Boxes of a darknet label file, one "class x y w h" line per object in normalized coordinates.
+std::vector<RosBox_> readLabels(const std::string& labelDir, const std::string& imagePath) {
+  std::vector<RosBox_> labels;
+  const size_t slash = imagePath.rfind('/');
+  const std::string name = imagePath.substr(slash == std::string::npos ? 0 : slash + 1);
+  std::ifstream in((labelDir + "/" + name.substr(0, name.rfind('.')) + ".txt").c_str());
+  RosBox_ box = {};
+  while (in >> box.Class >> box.x >> box.y >> box.w >> box.h) {
+    box.prob = 1;
+    labels.push_back(box);
+  }
+  return labels;
+}
+
+float iou(const RosBox_& a, const RosBox_& b) {
+  const float w = std::min(a.x + a.w / 2, b.x + b.w / 2) - std::max(a.x - a.w / 2, b.x - b.w / 2);
+  const float h = std::min(a.y + a.h / 2, b.y + b.h / 2) - std::max(a.y - a.h / 2, b.y - b.h / 2);
+  if (w <= 0 || h <= 0) return 0;
+  const float intersection = w * h;
+  return intersection / (a.w * a.h + b.w * b.h - intersection);
+}
+
+// Letterboxing or tiling, forward pass, NMS and box extraction as in YoloObjectDetector.
+std::vector<RosBox_> detect(network* net, image& input, letterbox_plan* plans, const cv::Mat& frame, const std::vector<cv::Rect>& tiles,
+                            int channelSwap, float thresh, int classes, double& ms) {
+  const Clock::time_point start = Clock::now();
+  for (size_t t = 0; t < tiles.size(); ++t) {
+    const bool whole = tiles[t].width == frame.cols && tiles[t].height == frame.rows;
+    image tileInput = float_to_image(net->w, net->h, net->c, input.data + t * net->inputs);
+    letterbox_mat_into(whole ? frame : frame(tiles[t]), channelSwap, tileInput, &plans[whole ? 0 : 1]);
+  }
+  network_predict(net, input.data);
+
+  darknet_ros::DetectionArena arena;
+  arena.resize(net, tiles.size());
+  const int nboxes = darknet_ros::getTiledBoxes(net, 0, frame.cols, frame.rows, tiles, thresh, .5, arena.detections());
+  darknet_ros::BoxPostprocessor postprocessor;
+  postprocessor.run(arena.detections(), nboxes, classes, thresh, .4);
+  std::vector<RosBox_> boxes(arena.capacity() + 1);
+  boxes.resize(postprocessor.extract(boxes.data(), boxes.size()));
+  ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  return boxes;
+}
+
+// Matches each reference box, most probable first, to the unmatched detection
+// of its class it overlaps most.
+void match(std::vector<RosBox_> reference, const std::vector<RosBox_>& detections, const cv::Mat& frame, Run& run) {
+  std::sort(reference.begin(), reference.end(), [](const RosBox_& a, const RosBox_& b) { return a.prob > b.prob; });
+  std::vector<bool> used(detections.size(), false);
+  for (const RosBox_& box : reference) {
+    int best = -1;
+    float bestIou = kMatchIou;
+    for (size_t j = 0; j < detections.size(); ++j) {
+      if (used[j] || detections[j].Class != box.Class) continue;
+      const float overlap = iou(box, detections[j]);
+      if (overlap >= bestIou) {
+        best = j;
+        bestIou = overlap;
+      }
+    }
+    if (best < 0) continue;
+    used[best] = true;
+    ++run.matched;
+    if (box.w * frame.cols * box.h * frame.rows < kSmallArea) ++run.smallMatched;
+  }
+  run.detections += detections.size();
+}
+
+void writeRun(std::ostream& out, const char* name, const Run& run, long objects, long smallObjects) {
+  const auto ratio = [](double numerator, double denominator) { return denominator > 0 ? numerator / denominator : 1.; };
+  out << "  \"" << name << "\": {\"ms_per_frame\": " << ratio(run.ms, run.images) << ", \"fps\": " << ratio(1000. * run.images, run.ms)
+      << ", \"detections\": " << run.detections << ", \"recall\": " << ratio(run.matched, objects)
+      << ", \"small_recall\": " << ratio(run.smallMatched, smallObjects) << "}";
+}
+
+void writeJson(std::ostream& out, const std::string& networkName, const Options& options, int columns, int rows, int images,
+               long objects, long smallObjects, const Run& letterboxed, const Run& tiled) {
+  out << "{\n  \"network\": \"" << networkName << "\",\n  \"images\": " << images << ",\n  \"reference\": \""
+      << (options.labelDir.empty() ? "tiled" : "labels") << "\",\n  \"objects\": " << objects << ",\n  \"small_objects\": " << smallObjects
+      << ",\n  \"tiles\": {\"columns\": " << columns << ", \"rows\": " << rows << ", \"size\": " << options.tileSize
+      << ", \"overlap\": " << options.overlap << ", \"full_frame\": " << (options.fullFrame ? "true" : "false") << "},\n";
+  writeRun(out, "letterboxed", letterboxed, objects, smallObjects);
+  out << ",\n";
+  writeRun(out, "tiled", tiled, objects, smallObjects);
+  out << "\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  YAML::Node model;
+  try {
+    model = YAML::LoadFile(options.config)["yolo_model"];
+  } catch (const YAML::Exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  if (!model) {
+    std::cerr << options.config << " is no model config.\n";
+    return 1;
+  }
+  const std::string networkName = model["config_file"]["name"].as<std::string>();
+  std::string cfgPath = options.networkDir + "/cfg/" + networkName;
+  std::string weightsPath = options.networkDir + "/weights/" + model["weight_file"]["name"].as<std::string>();
+  const float thresh = model["threshold"] ? model["threshold"]["value"].as<float>() : 0.3f;
+  const int classes = model["detection_classes"]["names"].size();
+  if (access(cfgPath.c_str(), R_OK) != 0 || access(weightsPath.c_str(), R_OK) != 0) {
+    std::cerr << "Missing " << cfgPath << " or " << weightsPath << ".\n";
+    return 1;
+  }
+  const std::vector<std::string> images = darknet_ros::listImages(options.imageDir);
+  const cv::Mat first = images.empty() ? cv::Mat() : cv::imread(images[0], cv::IMREAD_COLOR);
+  if (first.empty()) {
+    std::cerr << "No images found in " << options.imageDir << ".\n";
+    return 1;
+  }
+
+  // Like tiling/frame_width and tiling/frame_height, the first image fixes the grid.
+  const int columns = darknet_ros::tilesToCover(first.cols, options.tileSize, options.overlap);
+  const int rows = darknet_ros::tilesToCover(first.rows, options.tileSize, options.overlap);
+  const int tiles = columns * rows + (options.fullFrame ? 1 : 0);
+
+  std::vector<char> cfg(cfgPath.begin(), cfgPath.end());
+  std::vector<char> weights(weightsPath.begin(), weightsPath.end());
+  cfg.push_back(0);
+  weights.push_back(0);
+  network* single = darknet_ros::loadNetworkWithBatch(cfg.data(), weights.data(), 1);
+  network* batched = darknet_ros::loadNetworkWithBatch(cfg.data(), weights.data(), tiles);
+  darknet_ros::foldBatchNorm(single);
+  darknet_ros::foldBatchNorm(batched);
+
+  const int channelSwap = !mat_to_image_swaps_rb();
+  letterbox_plan plans[2] = {make_letterbox_plan(), make_letterbox_plan()};
+  image singleInput = make_image(single->w, single->h, single->c);
+  image batchedInput = make_image(batched->w, batched->h, batched->c * tiles);
+  Run letterboxed;
+  Run tiled;
+  long objects = 0;
+  long smallObjects = 0;
+  for (const std::string& path : images) {
+    const cv::Mat frame = cv::imread(path, cv::IMREAD_COLOR);
+    if (frame.empty()) continue;
+    const cv::Rect whole(0, 0, frame.cols, frame.rows);
+    std::vector<cv::Rect> frameTiles = darknet_ros::tileFrame(frame.cols, frame.rows, columns, rows, options.overlap);
+    if (options.fullFrame) frameTiles.insert(frameTiles.begin(), whole);
+
+    const std::vector<RosBox_> singleBoxes =
+        detect(single, singleInput, plans, frame, std::vector<cv::Rect>(1, whole), channelSwap, thresh, classes, letterboxed.ms);
+    const std::vector<RosBox_> tiledBoxes = detect(batched, batchedInput, plans, frame, frameTiles, channelSwap, thresh, classes, tiled.ms);
+    const std::vector<RosBox_> reference = options.labelDir.empty() ? tiledBoxes : readLabels(options.labelDir, path);
+    for (const RosBox_& box : reference) {
+      ++objects;
+      if (box.w * frame.cols * box.h * frame.rows < kSmallArea) ++smallObjects;
+    }
+    match(reference, singleBoxes, frame, letterboxed);
+    match(reference, tiledBoxes, frame, tiled);
+    ++letterboxed.images;
+    ++tiled.images;
+  }
+
+  if (options.output.empty()) {
+    writeJson(std::cout, networkName, options, columns, rows, letterboxed.images, objects, smallObjects, letterboxed, tiled);
+  } else {
+    std::ofstream out(options.output.c_str());
+    writeJson(out, networkName, options, columns, rows, letterboxed.images, objects, smallObjects, letterboxed, tiled);
+  }
+
+  free_image(singleInput);
+  free_image(batchedInput);
+  free_letterbox_plan(&plans[0]);
+  free_letterbox_plan(&plans[1]);
+  darknet_ros::freeNetwork(batched);
+  darknet_ros::freeNetwork(single);
+  return 0;
+}
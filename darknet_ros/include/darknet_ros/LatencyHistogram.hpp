@@ -0,0 +1,116 @@
+/*
+ * LatencyHistogram.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#pragma once
+
+// c++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace darknet_ros {
+
+/*!
+ * Latencies of the most recent samples, kept as a histogram with log spaced
+ * buckets next to the raw samples. Adding a sample evicts the oldest one once
+ * the window is full and costs O(1).
+ */
+class LatencyHistogram {
+ public:
+  /*!
+   * Constructor.
+   * @param[in] window number of most recent samples kept.
+   */
+  explicit LatencyHistogram(size_t window = 300)
+      : samples_(std::max<size_t>(window, 1)), counts_(bounds().size() + 1), next_(0), size_(0), sum_(0) {}
+
+  /*!
+   * Adds a sample [ms].
+   */
+  void add(double latency) {
+    if (size_ == samples_.size()) {
+      --counts_[bucket(samples_[next_])];
+      sum_ -= samples_[next_];
+    } else {
+      ++size_;
+    }
+    samples_[next_] = latency;
+    ++counts_[bucket(latency)];
+    sum_ += latency;
+    next_ = (next_ + 1) % samples_.size();
+  }
+
+  /*!
+   * Number of samples in the window.
+   */
+  size_t count() const { return size_; }
+
+  double mean() const { return size_ ? sum_ / size_ : 0; }
+
+  /*!
+   * Nearest rank percentile of the samples in the window.
+   * @param[in] p percentile in [0, 100].
+   * @param[in,out] scratch buffer reused between calls to avoid allocations.
+   */
+  double percentile(double p, std::vector<double>& scratch) const {
+    if (size_ == 0) return 0;
+    scratch.assign(samples_.begin(), samples_.begin() + size_);
+    const size_t rank = std::ceil(p / 100. * size_);
+    const size_t index = std::min(size_, std::max<size_t>(rank, 1)) - 1;
+    std::nth_element(scratch.begin(), scratch.begin() + index, scratch.end());
+    return scratch[index];
+  }
+
+  double max() const {
+    return size_ ? *std::max_element(samples_.begin(), samples_.begin() + size_) : 0;
+  }
+
+  /*!
+   * Samples per bucket, bucket i holds the latencies up to bounds()[i] and the last one all longer ones.
+   */
+  const std::vector<uint32_t>& counts() const { return counts_; }
+
+  /*!
+   * Upper bucket bounds [ms], four buckets per octave from 0.1 ms to about 13 s.
+   */
+  static const std::vector<double>& bounds() {
+    static const std::vector<double> bounds = [] {
+      std::vector<double> b;
+      for (int i = 0; i <= 68; ++i) b.push_back(0.1 * std::pow(2., i / 4.));
+      return b;
+    }();
+    return bounds;
+  }
+
+ private:
+  static size_t bucket(double latency) {
+    const std::vector<double>& b = bounds();
+    return std::lower_bound(b.begin(), b.end(), latency) - b.begin();
+  }
+
+  // Ring of the most recent samples, next_ is overwritten next.
+  std::vector<double> samples_;
+  std::vector<uint32_t> counts_;
+  size_t next_;
+  size_t size_;
+  double sum_;
+};
+
+/*!
+ * Milliseconds since start on the monotonic clock, and restarts start at now.
+ */
+inline double lapMilliseconds(std::chrono::steady_clock::time_point& start) {
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  const double elapsed = std::chrono::duration<double, std::milli>(now - start).count();
+  start = now;
+  return elapsed;
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,113 @@
+/*
+ * SpscQueue.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#pragma once
+
+// c++
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace darknet_ros {
+
+/*!
+ * Bounded lock-free queue for exactly one producer and one consumer thread.
+ * Used to hand frame slots from one pipeline stage to the next. An idle
+ * consumer parks on a condition variable, which push only signals while
+ * the consumer is parked.
+ */
+template <typename T>
+class SpscQueue {
+ public:
+  /*!
+   * Constructor.
+   * @param[in] capacity maximum number of elements held at once.
+   */
+  explicit SpscQueue(size_t capacity) : buffer_(capacity + 1), head_(0), tail_(0), waiting_(false) {}
+
+  /*!
+   * Appends an element. Must only be called from the producer thread.
+   * @return false if the queue is full.
+   */
+  bool push(const T& value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t next = increment(tail);
+    if (next == head_.load(std::memory_order_acquire)) return false;
+    buffer_[tail] = value;
+    // Sequentially consistent with the parking in pop: either the consumer
+    // sees the element or this sees the consumer waiting.
+    tail_.store(next, std::memory_order_seq_cst);
+    if (waiting_.load(std::memory_order_seq_cst)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      condition_.notify_one();
+    }
+    return true;
+  }
+
+  /*!
+   * Removes the oldest element. Must only be called from the consumer thread.
+   * @return false if the queue is empty.
+   */
+  bool pop(T& value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_seq_cst)) return false;
+    value = buffer_[head];
+    head_.store(increment(head), std::memory_order_release);
+    return true;
+  }
+
+  /*!
+   * Removes the oldest element, waiting up to timeout for one to arrive.
+   * Spins briefly, so a ready producer is picked up without a syscall, then
+   * sleeps until push wakes it.
+   * @return false if the queue stayed empty for the whole timeout.
+   */
+  template <typename Duration>
+  bool pop(T& value, const Duration& timeout) {
+    for (int spin = 0; spin < 64; ++spin) {
+      if (pop(value)) return true;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting_.store(true, std::memory_order_seq_cst);
+    bool popped = pop(value);
+    while (!popped && condition_.wait_until(lock, deadline) != std::cv_status::timeout) popped = pop(value);
+    waiting_.store(false, std::memory_order_relaxed);
+    return popped || pop(value);
+  }
+
+  /*!
+   * Number of elements currently queued. Only exact when called from the
+   * producer or consumer thread.
+   */
+  size_t size() const {
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return (tail + buffer_.size() - head) % buffer_.size();
+  }
+
+ private:
+  size_t increment(size_t index) const { return (index + 1) % buffer_.size(); }
+
+  // One slot is kept free to tell a full queue from an empty one.
+  std::vector<T> buffer_;
+
+  // Producer and consumer indices are kept on separate cache lines.
+  std::atomic<size_t> head_;
+  char padding_[64];
+  std::atomic<size_t> tail_;
+
+  // Parking of the consumer while the queue is empty.
+  std::atomic<bool> waiting_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+};
+
+} /* namespace darknet_ros*/
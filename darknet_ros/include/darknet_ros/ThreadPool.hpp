@@ -0,0 +1,144 @@
+/*
+ * ThreadPool.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#pragma once
+
+// c++
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace darknet_ros {
+
+/*!
+ * Persistent worker threads that split loops into contiguous ranges. The
+ * calling thread works on the first range, so a pool of n threads starts
+ * n - 1 workers.
+ */
+class ThreadPool {
+ public:
+  /*!
+   * Constructor.
+   * @param[in] threads number of threads working on a loop, including the caller.
+   * @param[in] cpus cores the threads are pinned to, the caller is expected on
+   * cpus[0] and worker i is pinned to cpus[(i + 1) % cpus.size()]. Empty for no
+   * pinning.
+   */
+  explicit ThreadPool(int threads, const std::vector<int>& cpus = std::vector<int>())
+      : body_(NULL), count_(0), parts_(0), pending_(0), generation_(0), stop_(false) {
+    for (int i = 1; i < threads; ++i) {
+      workers_.emplace_back(&ThreadPool::work, this, i);
+      if (!cpus.empty()) pinThread(workers_.back().native_handle(), cpus[i % cpus.size()]);
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /*!
+   * Number of threads working on a loop, including the caller.
+   */
+  int size() const { return workers_.size() + 1; }
+
+  /*!
+   * Calls body(begin, end) on disjoint ranges covering [0, count), one per
+   * thread, and returns when all ranges are done. Calls from several threads
+   * are run one after the other.
+   */
+  void parallelFor(int count, const std::function<void(int, int)>& body) {
+    const int parts = std::min(size(), count);
+    if (parts <= 1) {
+      if (count > 0) body(0, count);
+      return;
+    }
+    std::lock_guard<std::mutex> call(mutexCall_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      body_ = &body;
+      count_ = count;
+      parts_ = parts;
+      pending_ = workers_.size();
+      ++generation_;
+    }
+    wake_.notify_all();
+    runPart(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+    body_ = NULL;
+  }
+
+  /*!
+   * Pins the calling thread to a core.
+   * @return false if the core does not exist or may not be used.
+   */
+  static bool pinCurrentThread(int cpu) { return pinThread(pthread_self(), cpu); }
+
+ private:
+  static bool pinThread(pthread_t thread, int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+  }
+
+  void runPart(int part) {
+    if (part >= parts_) return;
+    const int begin = static_cast<long>(count_) * part / parts_;
+    const int end = static_cast<long>(count_) * (part + 1) / parts_;
+    (*body_)(begin, end);
+  }
+
+  void work(int part) {
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) return;
+      seen = generation_;
+      lock.unlock();
+      runPart(part);
+      lock.lock();
+      if (--pending_ == 0) done_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex mutexCall_;
+
+  // Loop of the current parallelFor, guarded by mutex_.
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(int, int)>* body_;
+  int count_;
+  int parts_;
+  size_t pending_;
+  size_t generation_;
+  bool stop_;
+};
+
+} /* namespace darknet_ros*/
@@ -14,15 +14,24 @@
 
 // c++
 #include <pthread.h>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 
+// boost
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
 // ROS
-#include <actionlib/server/simple_action_server.h>
+#include <actionlib/server/action_server.h>
+#include <diagnostic_updater/diagnostic_updater.h>
 #include <geometry_msgs/Point.h>
 #include <image_transport/image_transport.h>
 #include <ros/ros.h>
@@ -44,6 +53,8 @@
 #include <darknet_ros_msgs/ObjectCount.h>
 #include <darknet_ros_msgs/ObjDepth.h>    //For depth inclusion
 #include <darknet_ros_msgs/FrameDepth.h>  //For depth inclusion
+#include <darknet_ros_msgs/FrameFreshness.h>
+#include <darknet_ros_msgs/PipelineStatistics.h>
 
 
 // For depth-rgb image sync includes
@@ -74,23 +85,114 @@ extern "C" {
 // Image interface.
 #include "darknet_ros/image_interface.hpp"
 
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+// Precompiled networks.
+#include "darknet_ros/network_blob.hpp"
+
+// Batch normalization folding.
+#include "darknet_ros/batchnorm_folding.hpp"
+
+// INT8 convolutions.
+#include "darknet_ros/int8_inference.hpp"
+
+// Inference threads.
+#include "darknet_ros/inference_threads.hpp"
+
+// Box tracking between keyframes.
+#include "darknet_ros/box_tracking.hpp"
+
+// Change detection of static scenes.
+#include "darknet_ros/motion_gate.hpp"
+
+// Post-processing of the decoded detections.
+#include "darknet_ros/box_postprocessing.hpp"
+
+// Reused memory of the decoded detections.
+#include "darknet_ros/detection_arena.hpp"
+
+// Messages of the publish stage.
+#include "darknet_ros/box_messages.hpp"
+
+// Depth statistics of boxes.
+#include "darknet_ros/depth_statistics.hpp"
+
+// Temporal averaging of the predictions.
+#include "darknet_ros/prediction_averaging.hpp"
+
+// Pipeline hand-off queues.
+#include "darknet_ros/SpscQueue.hpp"
+
+// Stage latency statistics.
+#include "darknet_ros/LatencyHistogram.hpp"
+
 extern "C" cv::Mat image_to_mat(image im);
 extern "C" image mat_to_image(cv::Mat m);
 extern "C" int show_image(image p, const char* name, int ms);
 
 namespace darknet_ros {
 
-// Bounding box of the detected object.
-typedef struct {
-  float x, y, w, h, prob;
-  int num, Class;
-} RosBox_;
-
 typedef struct {
   cv::Mat image;
   std_msgs::Header header;
+  // Keeps the message memory alive if image shares it (zero-copy ingest).
+  cv_bridge::CvImageConstPtr source;
+  // Depth received with image, empty without depth.
+  cv::Mat depth;
+  cv_bridge::CvImageConstPtr depthSource;
 } CvMatWithHeader_;
 
+typedef actionlib::ServerGoalHandle<darknet_ros_msgs::CheckForObjectsAction> CheckForObjectsGoalHandle;
+
+// Check for objects action goal waiting for detection.
+typedef struct {
+  CheckForObjectsGoalHandle goal;
+  cv_bridge::CvImageConstPtr image;
+  ros::Time acceptTime;
+} PendingGoal_;
+
+// Stages of the detection pipeline timed for every frame. STAGE_TOTAL runs
+// from fetching a frame to publishing it, including the waits between stages.
+enum PipelineStage_ {
+  STAGE_FETCH,      // taking the frame from its camera or goal, full resolution copy if annotated
+  STAGE_LETTERBOX,  // network input
+  STAGE_PREDICT,    // network_predict of the whole batch
+  STAGE_AVERAGE,    // averaging the predictions of the last batches
+  STAGE_NMS,        // decoding the boxes and non-maximum suppression
+  STAGE_EXTRACT,    // box extraction
+  STAGE_TRACK,      // tracking the boxes between keyframes, and the tracker's image
+  STAGE_RENDER,     // drawing and converting the detection image
+  STAGE_DEPTH,      // depth association
+  STAGE_PUBLISH,    // publishing the results
+  STAGE_TOTAL,
+  NUM_PIPELINE_STAGES
+};
+
+// One image of a detection batch as it moves through the pipeline.
+typedef struct {
+  image buff;                // full resolution image, only filled if annotated
+  std_msgs::Header header;
+  ros::Time fetchTime;
+  int camera;                // index in cameras_, -1 for an action goal
+  PendingGoal_ goal;         // goal of the image if camera is -1
+  bool valid;                // false if the camera had no new frame for this batch
+  bool annotated;            // whether the detections are drawn into buff
+  size_t bytesCopied;
+  RosBox_* roiBoxes;
+  int roiBoxCapacity;          // boxes roiBoxes holds, the boxes of all detection layers of its images
+  bool keyframe;               // whether the network detects the frame, otherwise its boxes are tracked
+  bool unchanged;              // the frame did not change since the camera's last detected one, its boxes are reused
+  cv::Mat depth;               // depth received with the frame, empty without depth
+  cv_bridge::CvImageConstPtr depthSource;  // keeps the depth message alive until the entry is published
+  cv::Mat trackImage;          // downscaled gray image of the tracker, only with tracking
+  cv::Mat trackScratch;
+  int batchIndex;              // first image of the entry in the network batch
+  std::vector<cv::Rect> tiles; // parts of the frame in the batch images from batchIndex on, empty for the letterboxed frame
+  std::chrono::steady_clock::time_point fetchStart;
+  double stageTimes[NUM_PIPELINE_STAGES];  // [ms]
+} BatchEntry_;
+
 class YoloObjectDetector {
  public:
   /*!
@@ -117,40 +219,132 @@ class YoloObjectDetector {
 
   /*!
    * Synchronized callback of RGB camera and Depth Camera.
-   * @param[in] msg image pointer for RGB and Depth Camera Image.
+   * @param[in] msg image pointer for RGB and Depth Camera Image, msgdepth is null for cameras without depth.
+   * @param[in] index index of the camera in cameras_.
    */
-  void cameraCallback(const sensor_msgs::ImageConstPtr& msg, const sensor_msgs::ImageConstPtr& msgdepth);
+  void cameraCallback(const sensor_msgs::ImageConstPtr& msg, const sensor_msgs::ImageConstPtr& msgdepth, size_t index);
 
   /*!
    * Callback of Depth camera info.
    * @param[in] msg of camera info msg pointer.
+   * @param[in] index index of the camera in cameras_.
    */
-  void cameraDepthInfoCallback(const sensor_msgs::CameraInfoPtr& depthInfoMsg);
+  void cameraDepthInfoCallback(const sensor_msgs::CameraInfoConstPtr& depthInfoMsg, size_t index);
 
   /*!
-   * Check for objects action goal callback.
+   * Check for objects action goal callback, queues the goal for detection.
+   * @param[in] goal handle of the new goal.
    */
-  void checkForObjectsActionGoalCB();
+  void checkForObjectsActionGoalCB(CheckForObjectsGoalHandle goal);
 
   /*!
-   * Check for objects action preempt callback.
+   * Check for objects action cancel callback.
+   * @param[in] goal handle of the canceled goal.
    */
-  void checkForObjectsActionPreemptCB();
+  void checkForObjectsActionCancelCB(CheckForObjectsGoalHandle goal);
 
   /*!
-   * Check if a preempt for the check for objects action has been requested.
-   * @return false if preempt has been requested or inactive.
+   * Sends the detections of an action goal of a frame slot as its result.
+   * @param[in] index index of the goal in the batch.
    */
-  bool isCheckingForObjects() const;
+  void publishActionResult(int slot, size_t index);
+
+  // Approximate Depth Sync Policy objects
+  typedef image_transport::SubscriberFilter ImageSubscriberFilter;
+  typedef message_filters::sync_policies::ApproximateTime<sensor_msgs::Image, sensor_msgs::Image> MySyncPolicy_1;
+
+  // Subscriptions, publishers and latest frame of one camera stream.
+  struct CameraStream_ {
+    // Empty for the single camera configured by subscribers/camera_reading.
+    std::string name;
+    std::string imageTopic;
+    std::string depthTopic;
+    std::string depthInfoTopic;
+
+    // Approximately synchronized RGB and depth subscription, or RGB only if depthTopic is empty.
+    std::unique_ptr<ImageSubscriberFilter> imageSubscriber;
+    std::unique_ptr<ImageSubscriberFilter> depthSubscriber;
+    std::unique_ptr<message_filters::Synchronizer<MySyncPolicy_1> > sync;
+    image_transport::Subscriber imageOnlySubscriber;
+    ros::Subscriber depthInfoSubscriber;
+
+    ros::Publisher objectPublisher;
+    ros::Publisher boundingBoxesPublisher;
+    ros::Publisher detectionImagePublisher;
+    ros::Publisher depthTaggedDetectionImagePublisher;
+    ros::Publisher sceneDepthPublisher;
+    ros::Publisher frameFreshnessPublisher;
+
+    // Messages published last, reused by the publish stage once no subscriber holds them.
+    darknet_ros_msgs::BoundingBoxesPtr boundingBoxes;
+    darknet_ros_msgs::FrameDepthPtr frameDepth;
+
+    // Latest frame and the depth received with it, guarded by
+    // mutexImageCallback_. With zero-copy ingest camImageCopy shares the
+    // memory of the incoming message, which is kept alive by camImage. The
+    // depth is only read, so depthImage always shares it through camDepth.
+    std_msgs::Header imageHeader;
+    cv::Mat camImageCopy;
+    cv::Mat depthImage;
+    cv_bridge::CvImageConstPtr camImage;
+    cv_bridge::CvImageConstPtr camDepth;
+
+    // Counts the frames received, the fetch stage waits until it differs from the last frame fetched.
+    uint64_t frameSeq = 0;
+    uint64_t fetchedFrameSeq = 0;
+
+    // Frames dropped by the freshness scheduler, replaced by a newer frame
+    // before they were fetched, and published later than the latency budget.
+    std::atomic<uint32_t> droppedStale{0};
+    std::atomic<uint32_t> droppedSuperseded{0};
+    std::atomic<uint32_t> overBudget{0};
+    // Frames whose detection was skipped by the motion gate.
+    std::atomic<uint32_t> skippedUnchanged{0};
+
+    // Bytes copied since the last fetch, from the camera callback up to the network input.
+    std::atomic<size_t> bytesCopied{0};
+
+    // Depth camera intrinsics.
+    std::string depthFrame = "camera_color_optical_frame";
+    DepthIntrinsics_ intrinsics = {0, 0, 1, 1};
+
+    // Resampling tables of the fetch stage, for the whole frame and for its tiles.
+    letterbox_plan letterboxPlan;
+    letterbox_plan tilePlan;
+
+    // Tracker of the detect stage, and whether it asks the fetch stage for a keyframe.
+    std::unique_ptr<BoxTracker> tracker;
+    std::atomic<bool> keyframeDue{true};
+
+    // Motion gate of the fetch stage, and the last boxes of the detect stage
+    // that unchanged frames reuse. Only set with the motion gate.
+    std::unique_ptr<MotionGate> motionGate;
+    std::vector<RosBox_> lastBoxes;
+
+    // Detection image of the publish stage, and its copy the depth labels are drawn on.
+    cv::Mat disp;
+    cv::Mat depthTaggedDisp;
+  };
+
+  /*!
+   * Reads the camera streams from subscribers/cameras, or the single camera of subscribers/camera_reading.
+   */
+  void readCameras();
+
+  /*!
+   * Check if anybody subscribes to one of the detection images of a camera.
+   * @return true if detection_image or detection_depth_image has subscribers.
+   */
+  bool hasDetectionImageSubscribers(const CameraStream_& camera) const;
 
   /*!
    * Publishes the detection image.
    * @return true if successful.
    */
-  bool publishDetectionImage(const cv::Mat& detectionImage);
+  bool publishDetectionImage(CameraStream_& camera, const cv::Mat& detectionImage);
 
   // Using.
-  using CheckForObjectsActionServer = actionlib::SimpleActionServer<darknet_ros_msgs::CheckForObjectsAction>;
+  using CheckForObjectsActionServer = actionlib::ActionServer<darknet_ros_msgs::CheckForObjectsAction>;
   using CheckForObjectsActionServerPtr = std::shared_ptr<CheckForObjectsActionServer>;
 
   // ROS node handle.
@@ -163,123 +357,241 @@ class YoloObjectDetector {
   // Check for objects action server.
   CheckForObjectsActionServerPtr checkForObjectsActionServer_;
 
+  // Goals waiting for detection, guarded by mutexImageCallback_. Goals get
+  // actionBatchSlots_ entries of every batch next to the cameras, or take
+  // turns with the cameras for whole batches if it is 0.
+  std::deque<PendingGoal_> pendingGoals_;
+  int maxPendingGoals_;
+  int actionBatchSlots_;
+  bool servedGoalsLast_ = false;
+  letterbox_plan goalLetterboxPlan_;
+
   // Advertise and subscribe to image topics.
   image_transport::ImageTransport imageTransport_;
 
-  // Approximate Depth Sync Policy objects
-  typedef image_transport::SubscriberFilter ImageSubscriberFilter;
-  ImageSubscriberFilter imagergb_sub;
-  ImageSubscriberFilter imagedepth_sub;
-  typedef message_filters::sync_policies::ApproximateTime<sensor_msgs::Image, sensor_msgs::Image> MySyncPolicy_1;
-  message_filters::Synchronizer<MySyncPolicy_1> sync_1; 
-
-  // ROS subscriber and publisher.
-  image_transport::Subscriber imageSubscriber_;
-  ros::Subscriber cameraDepthInfoSubscriber_; 
-  ros::Publisher objectPublisher_;
-  ros::Publisher boundingBoxesPublisher_;
-  ros::Publisher sceneDepthPublisher_;
-
-  // Detected objects.
-  std::vector<std::vector<RosBox_> > rosBoxes_;
-  std::vector<int> rosBoxCounter_;
-  darknet_ros_msgs::BoundingBoxes boundingBoxesResults_;
-  darknet_ros_msgs::FrameDepth DepthMsg_;
-
-  // Camera related parameters.
-  int frameWidth_;
-  int frameHeight_;
-  std::string depth_frame_ = "camera_color_optical_frame";
-  float intrin_cx_ = 0 , intrin_cy_ = 0 , intrin_fx_ = 1, intrin_fy_ = 1; 
-
-  // Publisher of the bounding box image.
-  ros::Publisher detectionImagePublisher_;
-  ros::Publisher depthTaggedDetectionImagePublisher_;
-
-  // Yolo running on thread.
+  // Camera streams, all inferred in one batch.
+  std::vector<std::unique_ptr<CameraStream_> > cameras_;
+
+  // Tiled detection of the camera frames: every frame is split into
+  // tileColumns_ x tileRows_ overlapping tiles, detected in the batch images
+  // of its camera and merged by non-maximum suppression. The frame letterboxed
+  // as a whole is an extra image of the batch if tileFullFrame_ is set.
+  bool tiling_;
+  int tileColumns_ = 1;
+  int tileRows_ = 1;
+  double tileOverlap_ = 0;
+  bool tileFullFrame_ = true;
+  // Batch images of every camera, 1 without tiling.
+  int cameraBatchImages_ = 1;
+
+  // Detection on keyframes only, the boxes of the camera frames in between are
+  // tracked on gray images of at most trackingImageWidth_ pixels.
+  bool tracking_;
+  int trackingImageWidth_ = 640;
+
+  // Decoding and non-maximum suppression of the detect thread, sized for the
+  // entry with the most batch images.
+  DetectionArena detectionArena_;
+  BoxPostprocessor postprocessor_;
+
+  // Depth of the boxes of the publish stage, from a central window of each box.
+  std::unique_ptr<DepthEstimator> depthEstimator_;
+  std::vector<cv::Rect> depthBoxes_;
+  std::vector<float> boxDepths_;
+
+  // Boxes as darknet detections for drawing.
+  std::vector<detection> drawnDetections_;
+  std::vector<float> drawnProbs_;
+
+  // Yolo running on thread. It runs the publish stage of the pipeline.
   std::thread yoloThread_;
 
+  // Long-lived workers for the fetch and detect stages of the pipeline.
+  std::thread fetchThread_;
+  std::thread detectThread_;
+
+  // Frame slots handed between the stages: free -> fetch -> detect -> publish -> free.
+  SpscQueue<int> freeSlots_;
+  SpscQueue<int> fetchedSlots_;
+  SpscQueue<int> detectedSlots_;
+
+  // A stage waiting longer than this for a slot is reported as stalled [s].
+  double stallWarningTime_;
+
+  // Frames older than this when they would be published are not detected, 0 disables the check [s].
+  double latencyBudget_;
+
+  // Smoothed time from fetching a frame to publishing its detections [s].
+  std::atomic<double> pipelineLatency_;
+
+  // Latencies of every stage over the last frames, recorded by the publish
+  // stage and read by the statistics timer, guarded by mutexStatistics_.
+  std::vector<LatencyHistogram> stageLatencies_;
+  std::mutex mutexStatistics_;
+  std::vector<double> percentileScratch_;
+  ros::Publisher pipelineStatisticsPublisher_;
+  diagnostic_updater::Updater diagnosticUpdater_;
+  ros::WallTimer statisticsTimer_;
+
   // Darknet.
   char** demoNames_;
-  image** demoAlphabet_;
   int demoClasses_;
 
   network* net_;
-  std_msgs::Header headerBuff_[3];
-  image buff_[3];
+  // Precompiled network mapped instead of the cfg and weights, empty if not configured.
+  std::string networkBlobPath_;
+  // Images the INT8 input scales are calibrated on, empty if the network runs in FP32.
+  std::string int8CalibrationPath_;
+  // One entry per camera and the batched network input of each frame slot.
+  std::vector<BatchEntry_> batch_[3];
   image buffLetter_[3];
-  int buffId_[3];
-  int buffIndex_ = 0;
+  int channelSwap_;
   float fps_ = 0;
   float demoThresh_ = 0;
   float demoHier_ = .5;
-  int running_ = 0;
-  cv::Mat disp_;
   int demoDelay_ = 0;
-  int demoFrame_ = 3;
-  float** predictions_;
-  int demoIndex_ = 0;
-  int demoDone_ = 0;
-  float* lastAvg2_;
-  float* lastAvg_;
-  float* avg_;
-  int demoTotal_ = 0;
+  // Keyframe batches the predictions are averaged over, 1 for none.
+  int demoFrame_ = 1;
+  PredictionAverager predictionAverager_;
+  std::atomic<bool> demoDone_;
   double demoTime_;
 
-  RosBox_* roiBoxes_;
   bool viewImage_;
   bool enableConsoleOutput_;
+  int conversionThreads_;
+  // Threads of the convolutions, including the detect thread, and the cores they are pinned to.
+  int inferenceThreads_;
+  std::vector<int> inferenceCpus_;
   int waitKeyDelay_;
   int fullScreen_;
   char* demoPrefix_;
 
-  std_msgs::Header imageHeader_;
-  cv::Mat camImageCopy_;
-  cv::Mat depthImageCopy_;
+  bool zeroCopyIngest_;
   boost::shared_mutex mutexImageCallback_;
 
+  // Signalled by the camera callbacks, the fetch stage waits on it for a new frame.
+  boost::condition_variable_any newFrameCondition_;
+  std::chrono::steady_clock::time_point lastFetchTime_;
+  // Written by the fetch stage, read by the detect stage's console output.
+  std::atomic<double> idleFraction_{0};
+
+  // Frames nobody looks at are not rendered.
+  std::atomic<size_t> skippedRenders_;
+
   bool imageStatus_ = false;
   boost::shared_mutex mutexImageStatus_;
 
   bool isNodeRunning_ = true;
   boost::shared_mutex mutexNodeStatus_;
 
-  int actionId_;
-  boost::shared_mutex mutexActionStatus_;
 
 
-  int sizeNetwork(network* net);
+  void* detectInThread(int slot);
 
-  void rememberNetwork(network* net);
+  /*!
+   * Moves the boxes of the entry's camera to the frame of a non-keyframe entry.
+   */
+  void trackInThread(BatchEntry_& entry);
 
-  detection* avgPredictions(network* net, int* nboxes);
+  /*!
+   * Copies the last boxes of the entry's camera to an entry the motion gate found unchanged.
+   */
+  void reuseInThread(BatchEntry_& entry);
 
-  void* detectInThread();
+  /*!
+   * Draws boxes without darknet detections into the detection image of an entry.
+   */
+  void drawBoxes(BatchEntry_& entry, int count);
 
-  void* fetchInThread();
+  void* fetchInThread(int slot);
 
-  void* displayInThread(void* ptr);
+  void* displayInThread(int slot);
 
-  void* displayLoop(void* ptr);
+  /*!
+   * Checks whether a frame would be older than the latency budget by the
+   * time its detections are published.
+   * @param[in] stamp capture time of the frame.
+   * @return true if the frame should be dropped.
+   */
+  bool isStale(const ros::Time& stamp) const;
+
+  /*!
+   * Worker loop of the fetch stage, fills free slots with the latest camera image.
+   */
+  void fetchLoop();
+
+  /*!
+   * Blocks until a camera has a frame that has not been fetched yet or an action goal is pending.
+   * @return false if the pipeline is shutting down.
+   */
+  bool waitForNewFrame();
+
+  /*!
+   * Worker loop of the detect stage, runs the network on fetched slots.
+   */
+  void detectLoop();
 
-  void* detectLoop(void* ptr);
+  /*!
+   * Takes the next slot from a pipeline queue, reporting the stage as stalled
+   * if it has to wait longer than stallWarningTime_.
+   * @param[in] queue queue to take the slot from.
+   * @param[out] slot index of the frame slot.
+   * @param[in] stageName name of the waiting stage used in the report.
+   * @return false if the pipeline is shutting down.
+   */
+  bool waitForSlot(SpscQueue<int>& queue, int& slot, const char* stageName);
 
   void setupNetwork(char* cfgfile, char* weightfile, char* datafile, float thresh, char** names, int classes, int delay, char* prefix,
                     int avg_frames, float hier, int w, int h, int frames, int fullscreen);
 
   void yolo();
 
-  CvMatWithHeader_ getCvMatWithHeader();
+  CvMatWithHeader_ getCvMatWithHeader(const CameraStream_& camera);
 
   bool getImageStatus(void);
 
   bool isNodeRunning(void);
 
-  void* publishInThread();
+  /*!
+   * Converts the detections of a batch entry into pixel coordinates in boundingBoxes.
+   * @return number of detections.
+   */
+  int collectBoundingBoxes(const BatchEntry_& entry, std::vector<darknet_ros_msgs::BoundingBox>& boundingBoxes);
 
-  darknet_ros_msgs::ObjDepth associateDepth(const darknet_ros_msgs::BoundingBox& bbox, darknet_ros_msgs::ObjDepth ObjDepthMsg);
+  /*!
+   * Publishes the detections of one camera of a frame slot on the topics of that camera.
+   * @param[in] index index of the camera's entry in the batch.
+   * @param[in] rendered whether camera.disp holds the detection image of this entry,
+   *            the detection images are only published then.
+   */
+  void* publishInThread(int slot, size_t index, bool rendered);
+
+  /*!
+   * Adds the stage times of a published frame to the latency statistics.
+   */
+  void recordStageTimes(const BatchEntry_& entry);
+
+  /*!
+   * Publishes the latency statistics of all stages and updates the diagnostics.
+   */
+  void publishPipelineStatistics(const ros::WallTimerEvent& event);
+
+  /*!
+   * Diagnostic task reporting the latency percentiles of the pipeline stages.
+   */
+  void pipelineDiagnostics(diagnostic_updater::DiagnosticStatusWrapper& status);
+
+  /*!
+   * Publishes the age of a published frame and the frame drop counters of its camera.
+   */
+  void publishFrameFreshness(CameraStream_& camera, const BatchEntry_& entry);
+
+  /*!
+   * Fills the depth message of a box at depth [mm] from the depth estimator.
+   */
+  void associateDepth(const CameraStream_& camera, const darknet_ros_msgs::BoundingBox& bbox, float depth, darknet_ros_msgs::ObjDepth& ObjDepthMsg);
 
-  bool publishDepthTaggedDetectionImage(const cv::Mat& detectionImage,const darknet_ros_msgs::FrameDepth& frameDepthMsg);
+  bool publishDepthTaggedDetectionImage(CameraStream_& camera, const cv::Mat& detectionImage,const darknet_ros_msgs::FrameDepth& frameDepthMsg);
 
 };
 
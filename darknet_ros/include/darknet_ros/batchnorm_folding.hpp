@@ -0,0 +1,31 @@
+/*
+ * batchnorm_folding.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Inference-only convolutions: the batch normalization statistics are folded
+ *  into the weights and biases once, so the forward pass is a convolution with
+ *  bias and activation.
+ */
+
+#pragma once
+
+// Darknet.
+extern "C" {
+#include "network.h"
+}
+
+namespace darknet_ros {
+
+/*!
+ * Folds the batch normalization of the convolutional layers into their weights
+ * and biases, in place, and clears batch_normalize. Binary and XNOR layers are
+ * left unchanged. On the CPU, all convolutional layers without batch
+ * normalization then run a forward pass that starts the GEMM from the biases
+ * and activates each output block while it is in cache.
+ * @return number of layers folded.
+ */
+int foldBatchNorm(network* net);
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,52 @@
+/*
+ * box_messages.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Messages of the publish stage, built in one pass into buffers that are
+ *  reused once no subscriber holds on to them.
+ */
+
+#pragma once
+
+// c++
+#include <string>
+#include <vector>
+
+// boost
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+// darknet_ros_msgs
+#include <darknet_ros_msgs/BoundingBox.h>
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+namespace darknet_ros {
+
+/*!
+ * Writes the boxes in pixel coordinates of a frameWidth x frameHeight frame
+ * into boundingBoxes, in the order of the boxes. The array is resized rather
+ * than rebuilt, so a reused message keeps its capacity and label strings.
+ * Boxes of classes without a label are skipped.
+ * @param[in] trackIds whether the ids of the boxes are track ids, the class index is the id otherwise.
+ * @return number of bounding boxes.
+ */
+int fillBoundingBoxes(const RosBox_* boxes, int count, int frameWidth, int frameHeight, const std::vector<std::string>& classLabels,
+                      bool trackIds, std::vector<darknet_ros_msgs::BoundingBox>& boundingBoxes);
+
+/*!
+ * The message published last if no subscriber holds on to it any more, so
+ * its buffers are reused, and a new message otherwise. Nodelets of the same
+ * process receive a published message without a copy and keep a reference
+ * to it while they use it.
+ */
+template <typename Message>
+boost::shared_ptr<Message>& recycleMessage(boost::shared_ptr<Message>& message) {
+  if (!message || !message.unique()) message = boost::make_shared<Message>();
+  return message;
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,80 @@
+/*
+ * box_postprocessing.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Post-processing of the decoded detections: the probabilities above the
+ *  threshold are compacted into candidates first, and the candidates are
+ *  suppressed class by class, so the work follows the candidates rather than
+ *  the number of boxes times the number of classes.
+ */
+
+#pragma once
+
+// c++
+#include <vector>
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+namespace darknet_ros {
+
+// Boxes that survived the non-maximum suppression, one per detection and
+// class, in normalized image coordinates.
+struct BoxArrays_ {
+  std::vector<float> x, y, w, h, prob;
+  std::vector<int> Class;
+
+  size_t size() const { return prob.size(); }
+  void clear();
+  void push_back(float x, float y, float w, float h, float prob, int Class);
+};
+
+/*!
+ * Class-aware non-maximum suppression with buffers that are reused from
+ * frame to frame.
+ */
+class BoxPostprocessor {
+ public:
+  /*!
+   * Compacts the class probabilities above thresh into candidates, sorts the
+   * candidates of each class by probability and keeps a candidate unless it
+   * overlaps a kept candidate of its class by more than nmsThresh.
+   * Detections whose objectness is not above thresh are skipped without
+   * looking at their classes, darknet's class probabilities do not exceed it.
+   * @param[in] classes number of classes looked at, at most the classes of the detections.
+   * @return number of boxes kept.
+   */
+  int run(const detection* dets, int nboxes, int classes, float thresh, float nmsThresh);
+
+  /*!
+   * Boxes kept by the last run, most probable first within each class.
+   */
+  const BoxArrays_& boxes() const { return boxes_; }
+
+  /*!
+   * Copies the kept boxes clipped to the image, skipping those smaller than
+   * 1% of the image in either direction like extractBoxes.
+   * @param[out] boxes receives the boxes, boxes[0].num is set to their number.
+   * @param[in] capacity number of boxes that fit, the boxes beyond are dropped.
+   * @return number of boxes.
+   */
+  int extract(RosBox_* boxes, int capacity) const;
+
+ private:
+  struct Candidate {
+    float prob;
+    int det;
+    int Class;
+  };
+
+  std::vector<Candidate> candidates_;
+  std::vector<Candidate> sorted_;
+  std::vector<int> classStarts_;
+  // Corners and area of the boxes kept of the current class.
+  std::vector<float> left_, top_, right_, bottom_, area_;
+  BoxArrays_ boxes_;
+};
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,104 @@
+/*
+ * box_tracking.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Tracking of detected boxes between the keyframes the network runs on. The
+ *  boxes follow the median optical flow of a grid of points inside them, and
+ *  the keyframe interval adapts to how well the points can be followed.
+ */
+
+#pragma once
+
+// c++
+#include <vector>
+
+// OpenCv
+#include <opencv2/core/core.hpp>
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+namespace darknet_ros {
+
+class BoxTracker {
+ public:
+  /*!
+   * Constructor.
+   * @param[in] minInterval, maxInterval range of frames from one keyframe to the next.
+   * @param[in] minConfidence share of the points of a box that must be followed
+   * for the box to be kept, and of all points for the interval to be kept.
+   */
+  BoxTracker(int minInterval, int maxInterval, double minConfidence);
+
+  /*!
+   * Restarts the tracks at the boxes detected in a keyframe. A box overlapping
+   * a track of its class keeps the id of the track, other boxes get new ids.
+   * @param[in,out] boxes boxes in normalized coordinates, their id is set.
+   * @param[in] gray 8 bit gray image of the keyframe.
+   */
+  void update(RosBox_* boxes, int count, const cv::Mat& gray);
+
+  /*!
+   * Moves the tracks to the next frame. Tracks whose points are lost are dropped.
+   * @param[in] gray 8 bit gray image of the frame, the size of the keyframe's.
+   * @return share of the points followed, 1 without tracks.
+   */
+  double propagate(const cv::Mat& gray);
+
+  /*!
+   * Copies the tracked boxes, boxes[0].num is set to their number like extractBoxes.
+   * @param[out] boxes room for at least one box, and for every track.
+   * @return number of boxes.
+   */
+  int boxes(RosBox_* boxes) const;
+
+  /*!
+   * Number of tracked boxes.
+   */
+  int size() const { return tracks_.size(); }
+
+  /*!
+   * Whether the next frame should be a keyframe: the interval is over or the
+   * tracks were lost since the last keyframe.
+   */
+  bool keyframeDue() const { return lost_ || framesSinceKeyframe_ + 1 >= interval_; }
+
+  /*!
+   * Current number of frames from one keyframe to the next.
+   */
+  int interval() const { return interval_; }
+
+ private:
+  struct Track {
+    RosBox_ box;
+    std::vector<cv::Point2f> points;
+  };
+
+  // Points on a grid inside the box, in pixels of an image of w x h.
+  static void seedPoints(Track& track, int w, int h);
+
+  std::vector<Track> tracks_;
+  cv::Mat previous_;
+  int nextId_;
+  int minInterval_;
+  int maxInterval_;
+  int interval_;
+  int framesSinceKeyframe_;
+  double minConfidence_;
+  bool lost_;
+
+  // Scratch of propagate.
+  std::vector<cv::Point2f> from_;
+  std::vector<cv::Point2f> to_;
+  std::vector<cv::Point2f> back_;
+  std::vector<unsigned char> status_;
+  std::vector<unsigned char> backStatus_;
+  std::vector<float> error_;
+  std::vector<float> dx_;
+  std::vector<float> dy_;
+  std::vector<float> scales_;
+};
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,77 @@
+/*
+ * depth_statistics.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Depth of a bounding box from the valid pixels of a central window of the
+ *  box in a 16 bit depth image, rather than from its center pixel alone.
+ */
+
+#pragma once
+
+// c++
+#include <string>
+
+// OpenCv
+#include <opencv2/core/core.hpp>
+
+// Worker threads.
+#include "darknet_ros/ThreadPool.hpp"
+
+namespace darknet_ros {
+
+// Statistic of the valid depths of the window of a box.
+enum DepthStatistic_ {
+  DEPTH_CENTER,        // the center pixel, zero on a hole
+  DEPTH_MEDIAN,
+  DEPTH_TRIMMED_MEAN,  // mean of the depths between the trim and 1 - trim quantiles
+  DEPTH_PERCENTILE     // the percentile quantile, the near side of the object
+};
+
+/*!
+ * Statistic of the name used in the parameters: center, median, trimmed_mean
+ * or percentile.
+ * @return false for an unknown name.
+ */
+bool parseDepthStatistic(const std::string& name, DepthStatistic_& statistic);
+
+/*!
+ * Depth statistics of boxes over the pixels of a central window of each box,
+ * ignoring zeros, the pixels without depth. The depths are counted in a
+ * histogram of their high byte and one of the low bytes of the bin holding
+ * the rank looked for, vectorized with SSE2 where available, so the cost is
+ * linear in the pixels. Large windows are sampled on a subset of their rows.
+ */
+class DepthEstimator {
+ public:
+  /*!
+   * Constructor.
+   * @param[in] window width and height of the window as a fraction of the box.
+   * @param[in] trim fraction of the depths left out at either end by the trimmed mean.
+   * @param[in] percentile quantile of DEPTH_PERCENTILE, in [0, 1].
+   * @param[in] threads number of threads the boxes of a frame are split over, including the caller.
+   */
+  DepthEstimator(DepthStatistic_ statistic, double window, double trim, double percentile, int threads);
+
+  /*!
+   * Depth of a box in a 16UC1 depth image [mm], 0 if the window has no valid
+   * depth or lies outside of the image.
+   * @param[in] box box in pixels of the depth image.
+   */
+  float estimate(const cv::Mat& depth, const cv::Rect& box) const;
+
+  /*!
+   * Depths of count boxes [mm], split over the threads.
+   */
+  void estimate(const cv::Mat& depth, const cv::Rect* boxes, int count, float* depths);
+
+ private:
+  DepthStatistic_ statistic_;
+  double window_;
+  double trim_;
+  double percentile_;
+  ThreadPool pool_;
+};
+
+} /* namespace darknet_ros*/
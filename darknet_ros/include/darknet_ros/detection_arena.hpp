@@ -0,0 +1,56 @@
+/*
+ * detection_arena.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Memory of the decoded detections, allocated once for the network and
+ *  reused from frame to frame instead of get_network_boxes' arrays.
+ */
+
+#pragma once
+
+// c++
+#include <vector>
+
+// Darknet.
+extern "C" {
+#include "network.h"
+}
+
+namespace darknet_ros {
+
+/*!
+ * Number of boxes the detection layers of the network decode for one image,
+ * all of its YOLO heads together.
+ */
+int maxDetections(const network* net);
+
+/*!
+ * Detections with their class probabilities and masks in contiguous buffers.
+ */
+class DetectionArena {
+ public:
+  /*!
+   * Sizes the arena for the boxes of the given number of images of the
+   * network. Detections handed out before are invalidated.
+   */
+  void resize(const network* net, int images);
+
+  /*!
+   * The detections, each with the class probabilities and mask it needs.
+   */
+  detection* detections() { return dets_.data(); }
+
+  /*!
+   * Number of detections the arena holds.
+   */
+  int capacity() const { return dets_.size(); }
+
+ private:
+  std::vector<detection> dets_;
+  std::vector<float> probs_;
+  std::vector<float> masks_;
+};
+
+} /* namespace darknet_ros*/
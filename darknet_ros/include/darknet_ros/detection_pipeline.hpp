@@ -0,0 +1,116 @@
+/*
+ * detection_pipeline.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Stages of the detection pipeline that do not depend on ROS, shared by
+ *  YoloObjectDetector and the offline benchmark.
+ */
+
+#pragma once
+
+// c++
+#include <string>
+#include <vector>
+
+// OpenCv
+#include <opencv2/core/core.hpp>
+
+// Darknet.
+extern "C" {
+#include "network.h"
+#include "parser.h"
+}
+
+namespace darknet_ros {
+
+// Bounding box of the detected object.
+typedef struct {
+  float x, y, w, h, prob;
+  int num, Class;
+  int id;  // track id, only set by BoxTracker
+} RosBox_;
+
+// Pinhole intrinsics of a depth camera.
+typedef struct {
+  float cx, cy, fx, fy;
+} DepthIntrinsics_;
+
+/*!
+ * Builds the layers of the network described by the cfg text for batches of
+ * the given size, without loading weights.
+ */
+network* parseNetworkWithBatch(const std::string& cfg, int batch);
+
+/*!
+ * Loads the network for batches of the given size. Darknet sizes its buffers
+ * from the [net] section of the cfg, so larger batches load a temporary copy
+ * of the cfg with batch and subdivisions replaced.
+ */
+network* loadNetworkWithBatch(char* cfgfile, char* weightfile, int batch);
+
+/*!
+ * Decodes the boxes of one image of the batch, scaled to an image of w x h,
+ * into detections like get_network_boxes does, without allocating them.
+ * @param[in] b index of the image in the batch.
+ * @param[out] dets receives the boxes, room for maxDetections(net) of them with their probabilities.
+ * @return number of boxes.
+ */
+int getBatchBoxes(network* net, int b, int w, int h, float thresh, float hier, detection* dets);
+
+/*!
+ * Number of tiles of tileSize pixels, neighbours overlapping by the given
+ * fraction of a tile, needed to cover length pixels.
+ */
+int tilesToCover(int length, int tileSize, double overlap);
+
+/*!
+ * Splits a width x height frame into columns x rows tiles of equal size.
+ * Neighbouring tiles overlap by the given fraction of a tile and the outer
+ * tiles end at the frame borders.
+ */
+std::vector<cv::Rect> tileFrame(int width, int height, int columns, int rows, double overlap);
+
+/*!
+ * Decodes the boxes of a frame of w x h detected as tiles, batch image b + i
+ * holding tiles[i] letterboxed. The boxes of all tiles are moved to normalized
+ * coordinates of the frame and written one tile after the other, non-maximum
+ * suppression then merges them across the tiles.
+ * @param[out] dets receives the boxes, room for maxDetections(net) of them per tile.
+ * @return number of boxes.
+ */
+int getTiledBoxes(network* net, int b, int w, int h, const std::vector<cv::Rect>& tiles, float thresh, float hier, detection* dets);
+
+/*!
+ * Collects one box per detection and class with a nonzero probability, in
+ * normalized image coordinates clipped to the image. Boxes smaller than 1% of
+ * the image in either direction are skipped.
+ * @param[out] boxes receives the boxes, boxes[0].num is set to their number.
+ * @return number of boxes.
+ */
+int extractBoxes(const detection* dets, int nboxes, int classes, RosBox_* boxes);
+
+/*!
+ * Intersection over union of two boxes in normalized coordinates.
+ */
+float boxIou(const RosBox_& a, const RosBox_& b);
+
+/*!
+ * Paths of the PNG, JPEG and BMP images in a directory, sorted by name.
+ */
+std::vector<std::string> listImages(const std::string& dir);
+
+/*!
+ * Position of the pixel (u, v) in the camera frame [m], from a 16 bit depth
+ * image in mm. The depth is zero for an empty depth image and for pixels
+ * outside of it.
+ */
+cv::Point3f backProject(const cv::Mat& depth, const DepthIntrinsics_& intrinsics, int u, int v);
+
+/*!
+ * Position of the pixel (u, v) at depth Z [m] in the camera frame [m].
+ */
+cv::Point3f backProject(const DepthIntrinsics_& intrinsics, int u, int v, float Z);
+
+} /* namespace darknet_ros*/
@@ -12,8 +12,81 @@
 #include "image.h"
 #include "opencv2/opencv.hpp"
 
+/*
+ * Resampling tables and row cache of letterbox_mat_into. They depend only on
+ * the source and network size and are rebuilt when either changes.
+ */
+typedef struct {
+  int src_w, src_h, dst_w, dst_h;
+  int new_w, new_h, off_x, off_y;
+  int* x0;       // byte offset of the left source pixel of each output column
+  int* x1;       // byte offset of the right source pixel of each output column
+  float* fx;     // weight of the right source pixel
+  int* y0;       // upper source row of each output row
+  int* y1;       // lower source row of each output row, -1 if unused
+  float* fy;     // weight of the lower source row
+  float* rows[2];  // horizontally resampled source rows, planar
+  int row_y[2];    // source row held in rows, -1 if none
+} letterbox_plan;
+
 static float get_pixel(image m, int x, int y, int c);
-image** load_alphabet_with_file(char* datafile);
-void generate_image(image p, cv::Mat& disp);
+
+/*
+ * Label text is drawn from 8 bit glyph atlases of the printable ASCII
+ * characters, one per label size. An atlas is rendered on first use, so
+ * nothing is loaded at startup and only the sizes drawn are kept.
+ */
+enum { LABEL_SIZES = 8, FIRST_GLYPH = 32, GLYPH_COUNT = 95 };
+
+/*
+ * Renders the glyph atlas of a label size if it has not been yet.
+ * Returns its size in bytes.
+ */
+size_t load_glyph_atlas(int size);
+
+/*
+ * Draws text in black on a box of color rgb whose lower left corner is at
+ * (col, row), or whose upper left corner is if the box does not fit above.
+ * size is the label size in [0, LABEL_SIZES).
+ */
+void draw_label_text(image im, int row, int col, const char* text, const float* rgb, int size);
+
+/*
+ * Draws the labels of the detections like darknet's draw_detections does
+ * when given an alphabet, with the boxes drawn by draw_detections without
+ * one.
+ */
+void draw_detection_labels(image im, detection* dets, int num, float thresh, char** names, int classes);
+
+/*
+ * Converts the planar float image p into the interleaved 8 bit image disp,
+ * reversing the channel order of three channel images and saturating to
+ * [0, 255]. p is left unchanged. Rows are split across nthreads stripes of
+ * OpenCV's thread pool if nthreads > 1.
+ */
+void generate_image(image p, cv::Mat& disp, int nthreads = 1);
+
+letterbox_plan make_letterbox_plan();
+void free_letterbox_plan(letterbox_plan* plan);
+
+/*
+ * Whether darknet's mat_to_image swaps the B and R planes.
+ */
+int mat_to_image_swaps_rb();
+
+/*
+ * Converts an interleaved 8 bit BGR image into a preallocated planar float
+ * image of the same size, scaled to [0, 1]. Swaps the B and R planes if
+ * swap_rb is set.
+ */
+void mat_into_image(const cv::Mat& src, int swap_rb, image im);
+
+/*
+ * Letterboxes an interleaved 8 bit BGR image straight into the planar float
+ * network input boxed: channel order, 1/255 scaling and the bilinear resize of
+ * darknet's letterbox_image_into in a single pass, without a full resolution
+ * float copy of the source.
+ */
+void letterbox_mat_into(const cv::Mat& src, int swap_rb, image boxed, letterbox_plan* plan);
 
 #endif
@@ -0,0 +1,48 @@
+/*
+ * inference_threads.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  The thread pool the convolutions of darknet_ros split their GEMM, im2col
+ *  and activation loops over. Darknet calls the forward functions of the
+ *  layers without context, so the pool is shared by the process.
+ */
+
+#pragma once
+
+// c++
+#include <functional>
+#include <vector>
+
+namespace darknet_ros {
+
+/*!
+ * Replaces the inference thread pool. Must not be called while a network
+ * runs.
+ * @param[in] threads number of threads per loop, including the thread running
+ * the network.
+ * @param[in] cpus cores to pin the workers to, cpus[0] is left for the thread
+ * running the network, see pinInferenceThread. Empty for no pinning.
+ */
+void setInferenceThreads(int threads, const std::vector<int>& cpus);
+
+/*!
+ * Number of threads per loop, including the caller.
+ */
+int inferenceThreads();
+
+/*!
+ * Pins the calling thread, the one running the network, to cpus[0] of
+ * setInferenceThreads.
+ * @return false if not pinned.
+ */
+bool pinInferenceThread();
+
+/*!
+ * Calls body(begin, end) on disjoint ranges covering [0, count) on the
+ * inference threads and returns when all are done.
+ */
+void parallelFor(int count, const std::function<void(int begin, int end)>& body);
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,68 @@
+/*
+ * int8_inference.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  INT8 inference of convolutional layers on the CPU: weights quantized with
+ *  one scale per output channel, inputs with one scale per layer calibrated
+ *  on sample images, and int8 dot product kernels accumulating in int32.
+ */
+
+#pragma once
+
+// c++
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Darknet.
+extern "C" {
+#include "network.h"
+}
+
+namespace darknet_ros {
+
+// The inner dimension of the int8 kernels is padded with zeros to a multiple of this.
+const int kInt8Block = 32;
+
+inline int paddedDepth(int k) { return (k + kInt8Block - 1) / kInt8Block * kInt8Block; }
+
+/*!
+ * Quantizes a rows x k row-major matrix symmetrically to [-127, 127], with one
+ * scale per row.
+ * @param[out] quantized rows x kpad, zero padded.
+ * @param[out] scales value of one quantization step of each row.
+ */
+void quantizeRows(const float* values, int rows, int k, int kpad, int8_t* quantized, float* scales);
+
+/*!
+ * c[i * n + j] = scales[i] * inputScale * dot(row i of a, row j of bt) + biases[i]
+ * for an m x kpad matrix a and an n x kpad matrix bt. Uses AVX-VNNI, AVX2 or
+ * scalar kernels, picked at runtime, split over the inference threads.
+ * @param[in] biases per row of a, NULL for none.
+ */
+void gemmInt8(int m, int n, int kpad, const int8_t* a, const int8_t* bt, const float* scales, float inputScale, const float* biases, float* c);
+
+/*!
+ * Name of the dot product kernel gemmInt8 uses on this CPU.
+ */
+const char* int8KernelName();
+
+/*!
+ * Runs the convolutional layers of the network, except the first one, in
+ * INT8. The input scale of each layer is calibrated by running the network
+ * in FP32 over the calibration images. Layers with groups, binary or XNOR
+ * weights stay in FP32.
+ * @param[in] calibrationImages paths of the sample images.
+ * @param[out] error reason of a failure.
+ * @return number of layers switched to INT8, -1 on failure.
+ */
+int quantizeNetwork(network* net, const std::vector<std::string>& calibrationImages, std::string& error);
+
+/*!
+ * Drops the INT8 weights of a network before it is freed.
+ */
+void releaseQuantizedNetwork(network* net);
+
+} /* namespace darknet_ros*/
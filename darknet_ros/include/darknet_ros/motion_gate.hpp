@@ -0,0 +1,65 @@
+/*
+ * motion_gate.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Change detection of static camera scenes, so frames that do not differ
+ *  from the last detected one can reuse its detections.
+ */
+
+#pragma once
+
+// c++
+#include <vector>
+
+// OpenCv
+#include <opencv2/core/core.hpp>
+
+namespace darknet_ros {
+
+/*!
+ * Compares the mean brightness of square blocks of a frame, sampled on a
+ * sparse grid of pixels, with the blocks of the last frame that passed the
+ * gate.
+ */
+class MotionGate {
+ public:
+  /*!
+   * Constructor.
+   * @param[in] columns number of blocks across the frame.
+   * @param[in] threshold change of the mean brightness of a block that counts as changed [gray levels].
+   * @param[in] changedFraction share of the blocks that must change for the frame to pass.
+   * @param[in] refreshInterval frames pass after this many frames were held back, 0 for never.
+   */
+  MotionGate(int columns, double threshold, double changedFraction, int refreshInterval);
+
+  /*!
+   * Whether a BGR frame differs from the last frame that passed. Frames that
+   * pass, the first one and those of another size included, become the
+   * reference for the next frames.
+   */
+  bool changed(const cv::Mat& frame);
+
+  /*!
+   * Number of frames held back since the last frame that passed.
+   */
+  int unchangedFrames() const { return unchangedFrames_; }
+
+ private:
+  // Mean brightness of the blocks of the frame.
+  void measure(const cv::Mat& frame, std::vector<float>& blocks);
+
+  int columns_;
+  double threshold_;
+  double changedFraction_;
+  int refreshInterval_;
+  int unchangedFrames_;
+  cv::Size referenceSize_;
+  std::vector<float> reference_;
+  std::vector<float> current_;
+  // Samples per block of the frame being measured.
+  std::vector<int> counts_;
+};
+
+} /* namespace darknet_ros*/
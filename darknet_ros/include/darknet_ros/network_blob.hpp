@@ -0,0 +1,52 @@
+/*
+ * network_blob.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Precompiled networks: the cfg and the weights in the layout darknet holds
+ *  them in memory after loading, in one versioned and checksummed file that
+ *  is memory mapped instead of parsed and read.
+ */
+
+#pragma once
+
+// c++
+#include <string>
+
+// Darknet.
+extern "C" {
+#include "network.h"
+}
+
+namespace darknet_ros {
+
+// Version of the blob layout, blobs of other versions are rejected.
+const unsigned int kNetworkBlobVersion = 2;
+
+/*!
+ * Writes the cfg and the loaded weights of a network into a blob. Only
+ * convolutional, deconvolutional, connected and batchnorm layers may have
+ * weights.
+ * @param[in] net network loaded from cfgfile.
+ * @param[out] error reason of a failure.
+ * @return true if successful.
+ */
+bool writeNetworkBlob(network* net, const char* cfgfile, const char* blobfile, std::string& error);
+
+/*!
+ * Builds the network of a blob for batches of the given size. The layers use
+ * the weights in the mapped blob, whose pages are shared with all processes
+ * mapping the same file and copied only if written to.
+ * @param[out] error reason of a failure.
+ * @return the network, NULL if the blob cannot be read, has another version,
+ * a wrong checksum or does not match its cfg.
+ */
+network* loadNetworkBlob(const char* blobfile, int batch, std::string& error);
+
+/*!
+ * Frees a network of load_network, loadNetworkWithBatch or loadNetworkBlob.
+ */
+void freeNetwork(network* net);
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,64 @@
+/*
+ * prediction_averaging.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Temporal averaging of the outputs of the detection layers over the last
+ *  frames, as a running sum over a ring of the stored outputs of every image
+ *  of the batch.
+ */
+
+#pragma once
+
+// c++
+#include <vector>
+
+// Darknet.
+extern "C" {
+#include "network.h"
+}
+
+namespace darknet_ros {
+
+/*!
+ * Replaces the outputs of the YOLO, region and detection layers by their mean
+ * over the last frames. Each frame adds its outputs to the running sum and
+ * takes out those of the frame leaving the ring, so the cost per frame does
+ * not depend on the number of frames averaged. Every image of the batch has
+ * a ring of its own, and only the images of the stream a ring belongs to may
+ * be added to it.
+ */
+class PredictionAverager {
+ public:
+  /*!
+   * Sizes the rings for the detection layers of the network and all images
+   * of its batch, and forgets the frames stored so far.
+   * @param[in] frames number of frames averaged, averaging is off below 2.
+   */
+  void resize(const network* net, int frames);
+
+  int frames() const { return frames_; }
+
+  /*!
+   * Stores the outputs of the last forward pass for the batch images [first,
+   * first + images) and replaces them by the mean of the frames stored for
+   * each image. Until a ring is full the mean is over the frames stored so
+   * far. The other images are left alone. Does nothing with averaging off.
+   */
+  void update(network* net, int first, int images);
+
+ private:
+  int frames_ = 1;
+  // Outputs of the detection layers of one image.
+  size_t total_ = 0;
+  // Frames stored and slot of the newest frame, per batch image.
+  std::vector<int> stored_;
+  std::vector<int> newest_;
+  // Outputs of the stored frames, frames_ blocks of total_ per batch image.
+  std::vector<float> ring_;
+  // Sum of the stored outputs per batch image, in double so it does not drift.
+  std::vector<double> sum_;
+};
+
+} /* namespace darknet_ros*/
@@ -14,6 +14,7 @@
 #include "darknet_ros/YoloObjectDetector.hpp"
 #include <typeinfo>
 #include <X11/Xlib.h>
+#include <algorithm>
 
 #ifdef DARKNET_FILE_PATH
 std::string darknetFilePath_ = DARKNET_FILE_PATH;
@@ -28,16 +29,22 @@ char* weights;
 char* data;
 char** detectionNames;
 
+// Names of the PipelineStage_ values in statistics and diagnostics.
+static const char* const pipelineStageNames[NUM_PIPELINE_STAGES] = {
+    "fetch", "letterbox", "predict", "average", "nms", "extract", "track", "render", "depth", "publish", "total"};
+
 YoloObjectDetector::YoloObjectDetector(ros::NodeHandle nh)
     : nodeHandle_(nh), 
       imageTransport_(nodeHandle_), 
       numClasses_(0), 
       classLabels_(0), 
-      rosBoxes_(0), 
-      rosBoxCounter_(0),
-      imagergb_sub(imageTransport_,"/camera/color/image_raw",1),                      //For depth inclusion
-      imagedepth_sub(imageTransport_,"/camera/aligned_depth_to_color/image_raw",1),   //For depth inclusion
-      sync_1(MySyncPolicy_1(5), imagergb_sub, imagedepth_sub)                         //For depth inclusion
+      freeSlots_(3),
+      fetchedSlots_(3),
+      detectedSlots_(3),
+      pipelineLatency_(0),
+      diagnosticUpdater_(ros::NodeHandle(), nh),
+      demoDone_(false),
+      skippedRenders_(0)
   {
   ROS_INFO("[YoloObjectDetector] Node started.");
 
@@ -62,6 +69,36 @@ bool YoloObjectDetector::readParameters() {
   nodeHandle_.param("image_view/enable_opencv", viewImage_, true);
   nodeHandle_.param("image_view/wait_key_delay", waitKeyDelay_, 3);
   nodeHandle_.param("image_view/enable_console_output", enableConsoleOutput_, false);
+  nodeHandle_.param("image_view/conversion_threads", conversionThreads_, 1);
+  nodeHandle_.param("inference/threads", inferenceThreads_, 1);
+  nodeHandle_.param("inference/cpus", inferenceCpus_, std::vector<int>(0));
+  inferenceThreads_ = std::max(inferenceThreads_, 1);
+  nodeHandle_.param("pipeline/stall_warning_time", stallWarningTime_, 1.0);
+  nodeHandle_.param("scheduler/latency_budget", latencyBudget_, 0.0);
+  nodeHandle_.param("actions/camera_reading/queue_size", maxPendingGoals_, 10);
+  nodeHandle_.param("actions/camera_reading/batch_slots", actionBatchSlots_, 0);
+  actionBatchSlots_ = std::max(actionBatchSlots_, 0);
+  nodeHandle_.param("subscribers/camera_reading/zero_copy", zeroCopyIngest_, true);
+  nodeHandle_.param("tiling/enabled", tiling_, false);
+  if (tiling_) {
+    int tileSize, frameWidth, frameHeight;
+    nodeHandle_.param("tiling/tile_size", tileSize, 960);
+    nodeHandle_.param("tiling/overlap", tileOverlap_, 0.2);
+    nodeHandle_.param("tiling/frame_width", frameWidth, 1920);
+    nodeHandle_.param("tiling/frame_height", frameHeight, 1080);
+    nodeHandle_.param("tiling/full_frame", tileFullFrame_, true);
+    tileSize = std::max(tileSize, 1);
+    tileOverlap_ = std::min(std::max(tileOverlap_, 0.0), 0.9);
+    // The grid is fixed by the expected frame size, the batch is sized for it.
+    tileColumns_ = tilesToCover(frameWidth, tileSize, tileOverlap_);
+    tileRows_ = tilesToCover(frameHeight, tileSize, tileOverlap_);
+    cameraBatchImages_ = tileColumns_ * tileRows_ + (tileFullFrame_ ? 1 : 0);
+    ROS_INFO("[YoloObjectDetector] Detecting camera frames in %d x %d tiles%s.", tileColumns_, tileRows_,
+             tileFullFrame_ ? " and as a whole" : "");
+  }
+  int statisticsWindow;
+  nodeHandle_.param("statistics/window", statisticsWindow, 300);
+  stageLatencies_.assign(NUM_PIPELINE_STAGES, LatencyHistogram(std::max(statisticsWindow, 1)));
 
   // Check if Xserver is running on Linux.
   if (XOpenDisplay(NULL)) {
@@ -75,12 +112,95 @@ bool YoloObjectDetector::readParameters() {
   // Set vector sizes.
   nodeHandle_.param("yolo_model/detection_classes/names", classLabels_, std::vector<std::string>(0));
   numClasses_ = classLabels_.size();
-  rosBoxes_ = std::vector<std::vector<RosBox_> >(numClasses_);
-  rosBoxCounter_ = std::vector<int>(numClasses_);
+
+  readCameras();
+
+  bool motionGate;
+  nodeHandle_.param("motion_gate/enabled", motionGate, false);
+  if (motionGate) {
+    int columns, refreshInterval;
+    double threshold, changedFraction;
+    nodeHandle_.param("motion_gate/columns", columns, 32);
+    nodeHandle_.param("motion_gate/threshold", threshold, 8.0);
+    nodeHandle_.param("motion_gate/changed_fraction", changedFraction, 0.005);
+    nodeHandle_.param("motion_gate/refresh_interval", refreshInterval, 30);
+    for (auto& camera : cameras_) {
+      camera->motionGate.reset(new MotionGate(columns, threshold, changedFraction, refreshInterval));
+    }
+    ROS_INFO("[YoloObjectDetector] Reusing the detections of unchanged frames, refreshing every %d frames.", refreshInterval);
+  }
+
+  nodeHandle_.param("tracking/enabled", tracking_, false);
+  if (tracking_) {
+    int minInterval, maxInterval;
+    double minConfidence;
+    nodeHandle_.param("tracking/min_interval", minInterval, 2);
+    nodeHandle_.param("tracking/max_interval", maxInterval, 10);
+    nodeHandle_.param("tracking/min_confidence", minConfidence, 0.5);
+    nodeHandle_.param("tracking/image_width", trackingImageWidth_, 640);
+    trackingImageWidth_ = std::max(trackingImageWidth_, 32);
+    for (auto& camera : cameras_) {
+      camera->tracker.reset(new BoxTracker(minInterval, maxInterval, minConfidence));
+    }
+    ROS_INFO("[YoloObjectDetector] Detecting keyframes every %d to %d frames and tracking the boxes in between.", std::max(minInterval, 1),
+             std::max(maxInterval, minInterval));
+  }
+
+  std::string depthStatisticName;
+  double depthWindow, depthTrim, depthPercentile;
+  int depthThreads;
+  nodeHandle_.param("depth/statistic", depthStatisticName, std::string("median"));
+  nodeHandle_.param("depth/window", depthWindow, 0.5);
+  nodeHandle_.param("depth/trim", depthTrim, 0.1);
+  nodeHandle_.param("depth/percentile", depthPercentile, 0.2);
+  nodeHandle_.param("depth/threads", depthThreads, 2);
+  DepthStatistic_ depthStatistic;
+  if (!parseDepthStatistic(depthStatisticName, depthStatistic)) {
+    ROS_WARN("[YoloObjectDetector] Unknown depth statistic %s, using the median.", depthStatisticName.c_str());
+    depthStatistic = DEPTH_MEDIAN;
+  }
+  depthEstimator_.reset(new DepthEstimator(depthStatistic, depthWindow, depthTrim, depthPercentile, depthThreads));
 
   return true;
 }
 
+void YoloObjectDetector::readCameras() {
+  XmlRpc::XmlRpcValue cameraList;
+  if (nodeHandle_.getParam("subscribers/cameras", cameraList) && cameraList.getType() == XmlRpc::XmlRpcValue::TypeArray) {
+    for (int i = 0; i < cameraList.size(); ++i) {
+      XmlRpc::XmlRpcValue& entry = cameraList[i];
+      if (entry.getType() != XmlRpc::XmlRpcValue::TypeStruct || !entry.hasMember("name") || !entry.hasMember("topic")) {
+        ROS_ERROR("[YoloObjectDetector] Camera %d of subscribers/cameras needs a name and a topic, ignoring it.", i);
+        continue;
+      }
+      std::unique_ptr<CameraStream_> camera(new CameraStream_());
+      camera->name = static_cast<std::string>(entry["name"]);
+      camera->imageTopic = static_cast<std::string>(entry["topic"]);
+      if (entry.hasMember("depth_topic")) camera->depthTopic = static_cast<std::string>(entry["depth_topic"]);
+      if (entry.hasMember("depth_cam_info_topic")) camera->depthInfoTopic = static_cast<std::string>(entry["depth_cam_info_topic"]);
+      cameras_.push_back(std::move(camera));
+    }
+  }
+
+  // Single camera on the topics of subscribers/camera_reading.
+  if (cameras_.empty()) {
+    std::unique_ptr<CameraStream_> camera(new CameraStream_());
+    nodeHandle_.param("subscribers/camera_reading/topic", camera->imageTopic, std::string("/camera/color/image_raw"));
+    nodeHandle_.param("subscribers/depth_reading/topic", camera->depthTopic, std::string("/camera/aligned_depth_to_color/image_raw"));
+    nodeHandle_.param("subscribers/depth_cam_info/topic", camera->depthInfoTopic, std::string("/camera/aligned_depth_to_color/camera_info"));
+    cameras_.push_back(std::move(camera));
+  }
+  ROS_INFO("[YoloObjectDetector] Detecting on %zu camera stream(s) in one batch.", cameras_.size());
+}
+
+// Topic of a named camera: the camera name is inserted as namespace in front of the last name of topic.
+static std::string cameraTopic(const std::string& topic, const std::string& camera) {
+  if (camera.empty()) return topic;
+  const size_t slash = topic.rfind('/');
+  if (slash == std::string::npos) return camera + "/" + topic;
+  return topic.substr(0, slash + 1) + camera + topic.substr(slash);
+}
+
 void YoloObjectDetector::init() {
   ROS_INFO("[YoloObjectDetector] init().");
 
@@ -98,6 +218,18 @@ void YoloObjectDetector::init() {
   // Path to weights file.
   nodeHandle_.param("yolo_model/weight_file/name", weightsModel, std::string("yolov2-tiny.weights"));
   nodeHandle_.param("weights_path", weightsPath, std::string("/default"));
+  std::string blobModel;
+  nodeHandle_.param("yolo_model/network_blob/name", blobModel, std::string(""));
+  if (!blobModel.empty()) {
+    networkBlobPath_ = weightsPath + "/" + blobModel;
+  }
+  bool int8Enabled;
+  std::string int8Calibration;
+  nodeHandle_.param("yolo_model/int8/enabled", int8Enabled, false);
+  nodeHandle_.param("yolo_model/int8/calibration_images", int8Calibration, std::string("calibration"));
+  if (int8Enabled) {
+    int8CalibrationPath_ = int8Calibration[0] == '/' ? int8Calibration : weightsPath + "/" + int8Calibration;
+  }
   weightsPath += "/" + weightsModel;
   weights = new char[weightsPath.length() + 1];
   strcpy(weights, weightsPath.c_str());
@@ -122,13 +254,19 @@ void YoloObjectDetector::init() {
     strcpy(detectionNames[i], classLabels_[i].c_str());
   }
 
+  // Keyframe batches the detections are averaged over.
+  int averageFrames;
+  nodeHandle_.param("averaging/frames", averageFrames, 1);
+  if (averageFrames > 1) {
+    ROS_INFO("[YoloObjectDetector] Averaging the predictions over the last %d keyframes.", averageFrames);
+  }
+
   // Load network.
-  setupNetwork(cfg, weights, data, thresh, detectionNames, numClasses_, 0, 0, 1, 0.5, 0, 0, 0, 0);
+  setupNetwork(cfg, weights, data, thresh, detectionNames, numClasses_, 0, 0, std::max(averageFrames, 1), 0.5, 0, 0, 0, 0);
   yoloThread_ = std::thread(&YoloObjectDetector::yolo, this);
 
   // Initialize publisher and subscriber.
   //RGB Camera Topic Subscriber Params
-  std::string cameraTopicName;
   int cameraQueueSize;
 
   // Detection Message Publisher Params
@@ -145,7 +283,6 @@ void YoloObjectDetector::init() {
   std::string detectionImageTopicName;
   int detectionImageQueueSize;
   bool detectionImageLatch;
-  std::string depthTopicName; 
 
   //For depth inclusion
   //DepthSceneInfo Frame Publisher Params 
@@ -158,19 +295,27 @@ void YoloObjectDetector::init() {
   std::string detectionDepthImageTopicName;
   bool detectionDepthImageLatch;
 
+  // Frame Freshness Publisher Params
+  std::string frameFreshnessTopicName;
+  int frameFreshnessQueueSize;
+  bool frameFreshnessLatch;
+
+  // Pipeline Statistics Publisher Params
+  std::string pipelineStatisticsTopicName;
+  int pipelineStatisticsQueueSize;
+  bool pipelineStatisticsLatch;
+  double statisticsPeriod;
+
   // Depth Image Subscriber Params
   int cameraDepthInfoQueueSize; 
-  std::string cameraDepthInfoTopicName;
 
 
 
 
-  //RGB image [SUB]
-  nodeHandle_.param("subscribers/camera_reading/topic", cameraTopicName, std::string("/camera/color/image_raw"));
+  //RGB and depth image [SUB], the topics are read per camera by readCameras()
   nodeHandle_.param("subscribers/camera_reading/queue_size", cameraQueueSize, 1);
 
   // depth camera info topic [SUB]
-  nodeHandle_.param("subscribers/depth_cam_info/topic", cameraDepthInfoTopicName, std::string("/camera/aligned_depth_to_color/camera_info"));   //For depth inclusion
   nodeHandle_.param("subscribers/depth_cam_info/queue_size", cameraDepthInfoQueueSize, 1);                                                      //For depth inclusion
 
   //Object Detector [PUB]
@@ -198,43 +343,96 @@ void YoloObjectDetector::init() {
   nodeHandle_.param("publishers/object_depth/queue_size", sceneDepthQueueSize, 1);                                          //For depth inclusion
   nodeHandle_.param("publishers/object_depth/latch", sceneDepthLatch, true);                                                //For depth inclusion
 
+  // frame freshness topic [PUB]
+  nodeHandle_.param("publishers/frame_freshness/topic", frameFreshnessTopicName, std::string("frame_freshness"));
+  nodeHandle_.param("publishers/frame_freshness/queue_size", frameFreshnessQueueSize, 1);
+  nodeHandle_.param("publishers/frame_freshness/latch", frameFreshnessLatch, false);
+
+  // pipeline statistics topic [PUB]
+  nodeHandle_.param("publishers/pipeline_statistics/topic", pipelineStatisticsTopicName, std::string("pipeline_statistics"));
+  nodeHandle_.param("publishers/pipeline_statistics/queue_size", pipelineStatisticsQueueSize, 1);
+  nodeHandle_.param("publishers/pipeline_statistics/latch", pipelineStatisticsLatch, false);
+  nodeHandle_.param("statistics/period", statisticsPeriod, 1.0);
+
+
+  // Every camera publishes on its own namespace, the single unnamed camera on the configured topics.
+  for (auto& camera : cameras_) {
+    camera->objectPublisher = nodeHandle_.advertise<darknet_ros_msgs::ObjectCount>(
+        cameraTopic(objectDetectorTopicName, camera->name), objectDetectorQueueSize, objectDetectorLatch);
+    camera->boundingBoxesPublisher = nodeHandle_.advertise<darknet_ros_msgs::BoundingBoxes>(
+        cameraTopic(boundingBoxesTopicName, camera->name), boundingBoxesQueueSize, boundingBoxesLatch);
+    camera->detectionImagePublisher = nodeHandle_.advertise<sensor_msgs::Image>(
+        cameraTopic(detectionImageTopicName, camera->name), detectionImageQueueSize, detectionImageLatch);
+    camera->depthTaggedDetectionImagePublisher = nodeHandle_.advertise<sensor_msgs::Image>(
+        cameraTopic(detectionDepthImageTopicName, camera->name), detectionDepthImageQueueSize, detectionDepthImageLatch);
+    camera->sceneDepthPublisher = nodeHandle_.advertise<darknet_ros_msgs::FrameDepth>(
+        cameraTopic(sceneDepthTopicName, camera->name), sceneDepthQueueSize, sceneDepthLatch);
+    camera->frameFreshnessPublisher = nodeHandle_.advertise<darknet_ros_msgs::FrameFreshness>(
+        cameraTopic(frameFreshnessTopicName, camera->name), frameFreshnessQueueSize, frameFreshnessLatch);
+  }
+
+  // The stage latencies of all cameras are published together.
+  pipelineStatisticsPublisher_ = nodeHandle_.advertise<darknet_ros_msgs::PipelineStatistics>(
+      pipelineStatisticsTopicName, pipelineStatisticsQueueSize, pipelineStatisticsLatch);
+  diagnosticUpdater_.setHardwareID("none");
+  diagnosticUpdater_.add("Detection pipeline", this, &YoloObjectDetector::pipelineDiagnostics);
+  if (statisticsPeriod > 0) {
+    statisticsTimer_ = nodeHandle_.createWallTimer(ros::WallDuration(statisticsPeriod), &YoloObjectDetector::publishPipelineStatistics, this);
+  }
 
   // Replacing image callback with a approximately synchronized callback for depth and RGB images
-  cameraDepthInfoSubscriber_ = nodeHandle_.subscribe(cameraDepthInfoTopicName, 10, &YoloObjectDetector::cameraDepthInfoCallback, this);
-  sync_1.registerCallback(boost::bind(&YoloObjectDetector::cameraCallback,this,_1,_2));
-  
-  objectPublisher_ =
-      nodeHandle_.advertise<darknet_ros_msgs::ObjectCount>(objectDetectorTopicName, objectDetectorQueueSize, objectDetectorLatch);
-  boundingBoxesPublisher_ =
-      nodeHandle_.advertise<darknet_ros_msgs::BoundingBoxes>(boundingBoxesTopicName, boundingBoxesQueueSize, boundingBoxesLatch);
-  detectionImagePublisher_ =
-      nodeHandle_.advertise<sensor_msgs::Image>(detectionImageTopicName, detectionImageQueueSize, detectionImageLatch);
-  depthTaggedDetectionImagePublisher_ = 
-      nodeHandle_.advertise<sensor_msgs::Image>(detectionDepthImageTopicName, detectionDepthImageQueueSize, detectionDepthImageLatch);
-  sceneDepthPublisher_ = 
-      nodeHandle_.advertise<darknet_ros_msgs::FrameDepth>(sceneDepthTopicName, sceneDepthQueueSize, sceneDepthLatch);
+  for (size_t i = 0; i < cameras_.size(); ++i) {
+    CameraStream_& camera = *cameras_[i];
+    if (camera.depthTopic.empty()) {
+      camera.imageOnlySubscriber = imageTransport_.subscribe(
+          camera.imageTopic, cameraQueueSize,
+          boost::function<void(const sensor_msgs::ImageConstPtr&)>(
+              boost::bind(&YoloObjectDetector::cameraCallback, this, _1, sensor_msgs::ImageConstPtr(), i)));
+    } else {
+      camera.imageSubscriber.reset(new ImageSubscriberFilter(imageTransport_, camera.imageTopic, cameraQueueSize));
+      camera.depthSubscriber.reset(new ImageSubscriberFilter(imageTransport_, camera.depthTopic, cameraQueueSize));
+      camera.sync.reset(new message_filters::Synchronizer<MySyncPolicy_1>(MySyncPolicy_1(5), *camera.imageSubscriber, *camera.depthSubscriber));
+      camera.sync->registerCallback(boost::bind(&YoloObjectDetector::cameraCallback, this, _1, _2, i));
+    }
+    if (!camera.depthInfoTopic.empty()) {
+      camera.depthInfoSubscriber = nodeHandle_.subscribe<sensor_msgs::CameraInfo>(
+          camera.depthInfoTopic, cameraDepthInfoQueueSize, boost::bind(&YoloObjectDetector::cameraDepthInfoCallback, this, _1, i));
+    }
+  }
 
 
   // Action servers.
   std::string checkForObjectsActionName;
   nodeHandle_.param("actions/camera_reading/topic", checkForObjectsActionName, std::string("check_for_objects"));
   checkForObjectsActionServer_.reset(new CheckForObjectsActionServer(nodeHandle_, checkForObjectsActionName, false));
-  checkForObjectsActionServer_->registerGoalCallback(boost::bind(&YoloObjectDetector::checkForObjectsActionGoalCB, this));
-  checkForObjectsActionServer_->registerPreemptCallback(boost::bind(&YoloObjectDetector::checkForObjectsActionPreemptCB, this));
+  checkForObjectsActionServer_->registerGoalCallback(boost::bind(&YoloObjectDetector::checkForObjectsActionGoalCB, this, _1));
+  checkForObjectsActionServer_->registerCancelCallback(boost::bind(&YoloObjectDetector::checkForObjectsActionCancelCB, this, _1));
   checkForObjectsActionServer_->start();
 }
 
-void YoloObjectDetector::cameraCallback(const sensor_msgs::ImageConstPtr& msg, const sensor_msgs::ImageConstPtr& msgdepth) 
+// Bytes cv_bridge copied to produce image from msg, zero if it shares the message buffer.
+static size_t bytesCopiedByBridge(const sensor_msgs::ImageConstPtr& msg, const cv_bridge::CvImageConstPtr& image) {
+  if (!msg->data.empty() && image->image.data == &msg->data[0]) return 0;
+  return image->image.total() * image->image.elemSize();
+}
+
+void YoloObjectDetector::cameraCallback(const sensor_msgs::ImageConstPtr& msg, const sensor_msgs::ImageConstPtr& msgdepth, size_t index) 
 {
   // ROS_INFO("[YoloObjectDetector] DARKNET --> Camera image received.");
-  cv_bridge::CvImagePtr cam_image;
+  CameraStream_& camera = *cameras_[index];
+  cv_bridge::CvImageConstPtr cam_image;
   cv_bridge::CvImageConstPtr cam_depth; 
 
   try
   {
-    cam_image = cv_bridge::toCvCopy(msg, sensor_msgs::image_encodings::BGR8); 
-    cam_depth = cv_bridge::toCvCopy(msgdepth, sensor_msgs::image_encodings::TYPE_16UC1);
-    imageHeader_ = msg->header; 
+    if (zeroCopyIngest_) {
+      // Shares the message memory unless an encoding conversion is needed.
+      cam_image = cv_bridge::toCvShare(msg, sensor_msgs::image_encodings::BGR8);
+    } else {
+      cam_image = cv_bridge::toCvCopy(msg, sensor_msgs::image_encodings::BGR8); 
+    }
+    // The depth is never written, it is passed down the pipeline with its frame.
+    if (msgdepth) cam_depth = cv_bridge::toCvShare(msgdepth, sensor_msgs::image_encodings::TYPE_16UC1);
   }
   catch (cv_bridge::Exception& e)
   {
@@ -243,243 +441,523 @@ void YoloObjectDetector::cameraCallback(const sensor_msgs::ImageConstPtr& msg, c
   }
 
   if (cam_image) {
+    camera.bytesCopied += bytesCopiedByBridge(msg, cam_image);
+    if (cam_depth) camera.bytesCopied += bytesCopiedByBridge(msgdepth, cam_depth);
     {
       boost::unique_lock<boost::shared_mutex> lockImageCallback(mutexImageCallback_);
-      imageHeader_ = msg->header;
-      camImageCopy_ = cam_image->image.clone();
+      camera.imageHeader = msg->header;
+      camera.camImage = cam_image;
+      camera.camImageCopy = cam_image->image;
+      // Replaced together with the image, so a frame is never paired with another frame's depth.
+      camera.camDepth = cam_depth;
+      camera.depthImage = cam_depth ? cam_depth->image : cv::Mat();
+      ++camera.frameSeq;
     }
+    newFrameCondition_.notify_all();
     {
     boost::unique_lock<boost::shared_mutex> lockImageStatus(mutexImageStatus_);
     imageStatus_ = true;
     }
-    frameWidth_ = cam_image->image.size().width;
-    frameHeight_ = cam_image->image.size().height;
-  }
-
-  if (cam_depth)
-  {
-    depthImageCopy_ = cam_depth->image.clone();
   }
 
   return;
 }
 
-void YoloObjectDetector::checkForObjectsActionGoalCB() {
+void YoloObjectDetector::checkForObjectsActionGoalCB(CheckForObjectsGoalHandle goal) {
   ROS_DEBUG("[YoloObjectDetector] Start check for objects action.");
 
-  boost::shared_ptr<const darknet_ros_msgs::CheckForObjectsGoal> imageActionPtr = checkForObjectsActionServer_->acceptNewGoal();
-  sensor_msgs::Image imageAction = imageActionPtr->image;
-
-  cv_bridge::CvImagePtr cam_image;
+  boost::shared_ptr<const darknet_ros_msgs::CheckForObjectsGoal> imageActionPtr = goal.getGoal();
 
+  PendingGoal_ pendingGoal;
   try {
-    cam_image = cv_bridge::toCvCopy(imageAction, sensor_msgs::image_encodings::BGR8);
+    // The goal owns the image, so it is shared instead of copied.
+    pendingGoal.image = cv_bridge::toCvShare(imageActionPtr->image, imageActionPtr, sensor_msgs::image_encodings::BGR8);
   } catch (cv_bridge::Exception& e) {
     ROS_ERROR("cv_bridge exception: %s", e.what());
+    goal.setRejected(darknet_ros_msgs::CheckForObjectsResult(), e.what());
     return;
   }
 
-  if (cam_image) {
-    {
-      boost::unique_lock<boost::shared_mutex> lockImageCallback(mutexImageCallback_);
-      camImageCopy_ = cam_image->image.clone();
-    }
-    {
-      boost::unique_lock<boost::shared_mutex> lockImageCallback(mutexActionStatus_);
-      actionId_ = imageActionPtr->id;
-    }
-    {
-      boost::unique_lock<boost::shared_mutex> lockImageStatus(mutexImageStatus_);
-      imageStatus_ = true;
-    }
-    frameWidth_ = cam_image->image.size().width;
-    frameHeight_ = cam_image->image.size().height;
+  bool queueFull;
+  {
+    boost::shared_lock<boost::shared_mutex> lockImageCallback(mutexImageCallback_);
+    queueFull = pendingGoals_.size() >= static_cast<size_t>(maxPendingGoals_);
+  }
+  if (queueFull) {
+    ROS_WARN("[YoloObjectDetector] Rejected check for objects goal %d, %d goals are already waiting.", imageActionPtr->id, maxPendingGoals_);
+    goal.setRejected(darknet_ros_msgs::CheckForObjectsResult(), "Too many pending goals.");
+    return;
+  }
+
+  goal.setAccepted();
+  pendingGoal.goal = goal;
+  pendingGoal.acceptTime = ros::Time::now();
+  {
+    boost::unique_lock<boost::shared_mutex> lockImageCallback(mutexImageCallback_);
+    pendingGoals_.push_back(pendingGoal);
+  }
+  newFrameCondition_.notify_all();
+  {
+    boost::unique_lock<boost::shared_mutex> lockImageStatus(mutexImageStatus_);
+    imageStatus_ = true;
   }
-  return;
 }
 
-void YoloObjectDetector::checkForObjectsActionPreemptCB() {
-  ROS_DEBUG("[YoloObjectDetector] Preempt check for objects action.");
-  checkForObjectsActionServer_->setPreempted();
+void YoloObjectDetector::checkForObjectsActionCancelCB(CheckForObjectsGoalHandle goal) {
+  ROS_DEBUG("[YoloObjectDetector] Cancel check for objects action.");
+  {
+    boost::unique_lock<boost::shared_mutex> lockImageCallback(mutexImageCallback_);
+    for (auto it = pendingGoals_.begin(); it != pendingGoals_.end(); ++it) {
+      if (it->goal == goal) {
+        pendingGoals_.erase(it);
+        break;
+      }
+    }
+  }
+  // A goal already being detected gets no result.
+  goal.setCanceled();
 }
 
-bool YoloObjectDetector::isCheckingForObjects() const {
-  return (ros::ok() && checkForObjectsActionServer_->isActive() && !checkForObjectsActionServer_->isPreemptRequested());
+bool YoloObjectDetector::hasDetectionImageSubscribers(const CameraStream_& camera) const {
+  return camera.detectionImagePublisher.getNumSubscribers() > 0 || camera.depthTaggedDetectionImagePublisher.getNumSubscribers() > 0;
 }
 
-bool YoloObjectDetector::publishDetectionImage(const cv::Mat& detectionImage) {
-  if (detectionImagePublisher_.getNumSubscribers() < 1) return false;
+bool YoloObjectDetector::publishDetectionImage(CameraStream_& camera, const cv::Mat& detectionImage) {
+  if (camera.detectionImagePublisher.getNumSubscribers() < 1) return false;
   cv_bridge::CvImage cvImage;
   cvImage.header.stamp = ros::Time::now();
   cvImage.header.frame_id = "detection_image";
   cvImage.encoding = sensor_msgs::image_encodings::RGB8;
   cvImage.image = detectionImage;
-  detectionImagePublisher_.publish(*cvImage.toImageMsg());
+  camera.detectionImagePublisher.publish(*cvImage.toImageMsg());
   ROS_DEBUG("Detection image has been published.");
   return true;
 }
 
-int YoloObjectDetector::sizeNetwork(network* net) {
-  int i;
-  int count = 0;
-  for (i = 0; i < net->n; ++i) {
-    layer l = net->layers[i];
-    if (l.type == YOLO || l.type == REGION || l.type == DETECTION) {
-      count += l.outputs;
+void* YoloObjectDetector::detectInThread(int slot) {
+  float nms = .4;
+
+  // Batches without a keyframe, of tracked or unchanged frames only, skip the network.
+  bool keyframe = false;
+  for (const BatchEntry_& entry : batch_[slot]) {
+    keyframe = keyframe || (entry.valid && entry.keyframe);
+  }
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double predictTime = 0;
+  if (keyframe) {
+    network_predict(net_, buffLetter_[slot].data);
+    predictTime = lapMilliseconds(start);
+  }
+
+  if (enableConsoleOutput_) {
+    size_t bytesCopied = 0;
+    for (const BatchEntry_& entry : batch_[slot]) {
+      if (entry.valid) bytesCopied += entry.bytesCopied;
+    }
+    printf("\033[2J");
+    printf("\033[1;1H");
+    printf("\nFPS:%.1f\n", fps_);
+    printf("Bytes copied: %zu\n", bytesCopied);
+    printf("Skipped renders: %zu\n", skippedRenders_.load());
+    printf("Idle: %.0f%%\n", 100 * idleFraction_.load());
+    if (latencyBudget_ > 0) {
+      uint32_t droppedStale = 0;
+      for (const auto& camera : cameras_) droppedStale += camera->droppedStale;
+      printf("Stale drops: %u\n", droppedStale);
     }
+    if (cameras_[0]->motionGate) {
+      uint32_t skippedUnchanged = 0;
+      for (const auto& camera : cameras_) skippedUnchanged += camera->skippedUnchanged;
+      printf("Unchanged skips: %u\n", skippedUnchanged);
+    }
+    printf("Objects:\n\n");
   }
-  return count;
-}
 
-void YoloObjectDetector::rememberNetwork(network* net) {
-  int i;
-  int count = 0;
-  for (i = 0; i < net->n; ++i) {
-    layer l = net->layers[i];
-    if (l.type == YOLO || l.type == REGION || l.type == DETECTION) {
-      memcpy(predictions_[demoIndex_] + count, net->layers[i].output, sizeof(float) * l.outputs);
-      count += l.outputs;
+  for (size_t b = 0; b < batch_[slot].size(); ++b) {
+    BatchEntry_& entry = batch_[slot][b];
+    if (!entry.valid) continue;
+    if (entry.unchanged) {
+      reuseInThread(entry);
+      continue;
+    }
+    if (!entry.keyframe) {
+      trackInThread(entry);
+      continue;
+    }
+    entry.stageTimes[STAGE_PREDICT] = predictTime;
+
+    // Only the batch images of camera frames are averaged, each with the
+    // earlier keyframes of its camera. Goals take the entries of the cameras
+    // in turns and are detected on their own.
+    start = std::chrono::steady_clock::now();
+    if (entry.camera >= 0) {
+      predictionAverager_.update(net_, entry.batchIndex, cameraBatchImages_);
+      entry.stageTimes[STAGE_AVERAGE] = lapMilliseconds(start);
+    }
+
+    detection* dets = detectionArena_.detections();
+    int nboxes = 0;
+    if (entry.tiles.empty()) {
+      nboxes = getBatchBoxes(net_, entry.batchIndex, entry.buff.w, entry.buff.h, demoThresh_, demoHier_, dets);
+    } else {
+      nboxes = getTiledBoxes(net_, entry.batchIndex, entry.buff.w, entry.buff.h, entry.tiles, demoThresh_, demoHier_, dets);
+    }
+
+    // Also merges the detections of overlapping tiles, no suppression when nms is 0.
+    postprocessor_.run(dets, nboxes, demoClasses_, demoThresh_, nms > 0 ? nms : 1);
+    entry.stageTimes[STAGE_NMS] = lapMilliseconds(start);
+
+    if (enableConsoleOutput_ && batch_[slot].size() > 1) {
+      printf("%s:\n", entry.camera < 0 ? "check_for_objects" : cameras_[entry.camera]->name.c_str());
+    }
+
+    // extract the bounding boxes and send them to ROS
+    start = std::chrono::steady_clock::now();
+    RosBox_* roiBoxes = entry.roiBoxes;
+    int count = postprocessor_.extract(roiBoxes, entry.roiBoxCapacity);
+    entry.stageTimes[STAGE_EXTRACT] = lapMilliseconds(start);
+    if (entry.annotated) {
+      start = std::chrono::steady_clock::now();
+      drawBoxes(entry, count);
+      entry.stageTimes[STAGE_RENDER] = lapMilliseconds(start);
+    }
+    start = std::chrono::steady_clock::now();
+    if (tracking_ && entry.camera >= 0) {
+      CameraStream_& camera = *cameras_[entry.camera];
+      camera.tracker->update(roiBoxes, count, entry.trackImage);
+      camera.keyframeDue = camera.tracker->keyframeDue();
+      entry.stageTimes[STAGE_TRACK] += lapMilliseconds(start);
+    }
+    if (entry.camera >= 0 && cameras_[entry.camera]->motionGate) {
+      cameras_[entry.camera]->lastBoxes.assign(roiBoxes, roiBoxes + count);
+    }
+    // draw_detections lists the objects otherwise.
+    if (enableConsoleOutput_ && !entry.annotated) {
+      for (int i = 0; i < count; ++i) {
+        printf("%s: %.0f%%\n", demoNames_[roiBoxes[i].Class], roiBoxes[i].prob * 100);
+      }
     }
   }
+  return 0;
 }
 
-detection* YoloObjectDetector::avgPredictions(network* net, int* nboxes) {
-  int i, j;
-  int count = 0;
-  fill_cpu(demoTotal_, 0, avg_, 1);
-  for (j = 0; j < demoFrame_; ++j) {
-    axpy_cpu(demoTotal_, 1. / demoFrame_, predictions_[j], 1, avg_, 1);
+void YoloObjectDetector::trackInThread(BatchEntry_& entry) {
+  CameraStream_& camera = *cameras_[entry.camera];
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  camera.tracker->propagate(entry.trackImage);
+  const int count = camera.tracker->boxes(entry.roiBoxes);
+  camera.keyframeDue = camera.tracker->keyframeDue();
+  entry.stageTimes[STAGE_TRACK] += lapMilliseconds(start);
+  if (camera.motionGate) {
+    camera.lastBoxes.assign(entry.roiBoxes, entry.roiBoxes + count);
   }
-  for (i = 0; i < net->n; ++i) {
-    layer l = net->layers[i];
-    if (l.type == YOLO || l.type == REGION || l.type == DETECTION) {
-      memcpy(l.output, avg_ + count, sizeof(float) * l.outputs);
-      count += l.outputs;
+  if (enableConsoleOutput_) {
+    for (int i = 0; i < count; ++i) {
+      printf("%s %d (tracked): %.0f%%\n", demoNames_[entry.roiBoxes[i].Class], entry.roiBoxes[i].id, entry.roiBoxes[i].prob * 100);
     }
   }
-  detection* dets = get_network_boxes(net, buff_[0].w, buff_[0].h, demoThresh_, demoHier_, 0, 1, nboxes);
-  return dets;
+  if (entry.annotated) {
+    start = std::chrono::steady_clock::now();
+    drawBoxes(entry, count);
+    entry.stageTimes[STAGE_RENDER] = lapMilliseconds(start);
+  }
 }
 
-void* YoloObjectDetector::detectInThread() {
-  running_ = 1;
-  float nms = .4;
-
-  layer l = net_->layers[net_->n - 1];
-  float* X = buffLetter_[(buffIndex_ + 2) % 3].data;
-  float* prediction = network_predict(net_, X);
-
-  rememberNetwork(net_);
-  detection* dets = 0;
-  int nboxes = 0;
-  dets = avgPredictions(net_, &nboxes);
+void YoloObjectDetector::reuseInThread(BatchEntry_& entry) {
+  const std::vector<RosBox_>& boxes = cameras_[entry.camera]->lastBoxes;
+  std::copy(boxes.begin(), boxes.end(), entry.roiBoxes);
+  entry.roiBoxes[0].num = boxes.size();
+  if (entry.annotated) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    drawBoxes(entry, boxes.size());
+    entry.stageTimes[STAGE_RENDER] = lapMilliseconds(start);
+  }
+}
 
-  if (nms > 0) do_nms_obj(dets, nboxes, l.classes, nms);
+void YoloObjectDetector::drawBoxes(BatchEntry_& entry, int count) {
+  // The boxes are drawn as detections of their class alone.
+  drawnDetections_.assign(count, detection());
+  drawnProbs_.assign(count * demoClasses_, 0.f);
+  for (int i = 0; i < count; ++i) {
+    const RosBox_& box = entry.roiBoxes[i];
+    detection& det = drawnDetections_[i];
+    det.bbox.x = box.x;
+    det.bbox.y = box.y;
+    det.bbox.w = box.w;
+    det.bbox.h = box.h;
+    det.classes = demoClasses_;
+    det.objectness = box.prob;
+    det.prob = &drawnProbs_[i * demoClasses_];
+    det.prob[box.Class] = box.prob;
+  }
+  draw_detections(entry.buff, drawnDetections_.data(), count, demoThresh_, demoNames_, 0, demoClasses_);
+  draw_detection_labels(entry.buff, drawnDetections_.data(), count, demoThresh_, demoNames_, demoClasses_);
+}
 
-  if (enableConsoleOutput_) {
-    printf("\033[2J");
-    printf("\033[1;1H");
-    printf("\nFPS:%.1f\n", fps_);
-    printf("Objects:\n\n");
+void* YoloObjectDetector::fetchInThread(int slot) {
+  std::vector<BatchEntry_>& entries = batch_[slot];
+  std::vector<CvMatWithHeader_> frames(entries.size());
+  std::vector<PendingGoal_> goals;
+  size_t firstGoal = 0;
+  // Entries that sit this batch out, or are never published, let go of
+  // the depth of their last frame and of their last goal and its image here,
+  // outside of mutexImageCallback_.
+  for (BatchEntry_& entry : entries) {
+    entry.valid = false;
+    entry.depth.release();
+    entry.depthSource.reset();
+    entry.goal = PendingGoal_();
   }
-  image display = buff_[(buffIndex_ + 2) % 3];
-  draw_detections(display, dets, nboxes, demoThresh_, demoNames_, demoAlphabet_, demoClasses_);
+  const std::chrono::steady_clock::time_point fetchStart = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point start = fetchStart;
+  const ros::Time now = ros::Time::now();
+  {
+    boost::unique_lock<boost::shared_mutex> lock(mutexImageCallback_);
+    bool newFrames = false;
+    for (const auto& camera : cameras_) {
+      newFrames = newFrames || camera->frameSeq != camera->fetchedFrameSeq;
+    }
 
-  // extract the bounding boxes and send them to ROS
-  int i, j;
-  int count = 0;
-  for (i = 0; i < nboxes; ++i) {
-    float xmin = dets[i].bbox.x - dets[i].bbox.w / 2.;
-    float xmax = dets[i].bbox.x + dets[i].bbox.w / 2.;
-    float ymin = dets[i].bbox.y - dets[i].bbox.h / 2.;
-    float ymax = dets[i].bbox.y + dets[i].bbox.h / 2.;
-
-    if (xmin < 0) xmin = 0;
-    if (ymin < 0) ymin = 0;
-    if (xmax > 1) xmax = 1;
-    if (ymax > 1) ymax = 1;
-
-    // iterate through possible boxes and collect the bounding boxes
-    for (j = 0; j < demoClasses_; ++j) {
-      if (dets[i].prob[j]) {
-        float x_center = (xmin + xmax) / 2;
-        float y_center = (ymin + ymax) / 2;
-        float BoundingBox_width = xmax - xmin;
-        float BoundingBox_height = ymax - ymin;
-
-        // define bounding box
-        // BoundingBox must be 1% size of frame (3.2x2.4 pixels)
-        if (BoundingBox_width > 0.01 && BoundingBox_height > 0.01) {
-          roiBoxes_[count].x = x_center;
-          roiBoxes_[count].y = y_center;
-          roiBoxes_[count].w = BoundingBox_width;
-          roiBoxes_[count].h = BoundingBox_height;
-          roiBoxes_[count].Class = j;
-          roiBoxes_[count].prob = dets[i].prob[j];
-          count++;
-        }
+    // Goals either have entries of their own after the cameras in every
+    // batch, or take turns with the cameras for whole batches.
+    bool serveCameras = true;
+    if (actionBatchSlots_ > 0) {
+      firstGoal = cameras_.size();
+    } else if (!pendingGoals_.empty() && (!newFrames || !servedGoalsLast_)) {
+      serveCameras = false;
+    }
+    servedGoalsLast_ = !serveCameras;
+    // The goal handles are released outside of the lock, as that may lock the action server.
+    const size_t goalEntries = entries.size() - firstGoal;
+    while (goals.size() < goalEntries && !pendingGoals_.empty() && (!serveCameras || actionBatchSlots_ > 0)) {
+      goals.push_back(pendingGoals_.front());
+      pendingGoals_.pop_front();
+    }
+
+    for (size_t b = 0; serveCameras && b < cameras_.size(); ++b) {
+      CameraStream_& camera = *cameras_[b];
+      // Cameras without a new frame sit this batch out.
+      if (camera.frameSeq == camera.fetchedFrameSeq) continue;
+      camera.droppedSuperseded += camera.frameSeq - camera.fetchedFrameSeq - 1;
+      camera.fetchedFrameSeq = camera.frameSeq;
+      // Only the newest frame is kept, so a stale one means the camera waits for its next frame.
+      if (isStale(camera.imageHeader.stamp)) {
+        ++camera.droppedStale;
+        ROS_DEBUG_THROTTLE(1, "[YoloObjectDetector] Dropped a stale frame of camera %zu.", b);
+        continue;
       }
+      frames[b] = getCvMatWithHeader(camera);
+      entries[b].depth = frames[b].depth;
+      entries[b].depthSource = frames[b].depthSource;
+      entries[b].valid = true;
+      entries[b].camera = b;
+      entries[b].header = frames[b].header;
+      entries[b].fetchTime = now;
     }
   }
 
-  // create array to store found bounding boxes
-  // if no object detected, make sure that ROS knows that num = 0
-  if (count == 0) {
-    roiBoxes_[0].num = 0;
-  } else {
-    roiBoxes_[0].num = count;
+  for (size_t i = 0; i < goals.size(); ++i) {
+    const size_t b = firstGoal + i;
+    CvMatWithHeader_ frame = {.image = goals[i].image->image, .header = goals[i].image->header, .source = goals[i].image};
+    frames[b] = frame;
+    entries[b].valid = true;
+    entries[b].camera = -1;
+    entries[b].goal = goals[i];
+    entries[b].header = frame.header;
+    entries[b].fetchTime = now;
   }
 
-  free_detections(dets, nboxes);
-  demoIndex_ = (demoIndex_ + 1) % demoFrame_;
-  running_ = 0;
+  // Frames of static scenes reuse the boxes of their camera's last frame.
+  for (size_t b = 0; b < entries.size(); ++b) {
+    BatchEntry_& entry = entries[b];
+    entry.unchanged = false;
+    if (!entry.valid || entry.camera < 0 || !cameras_[entry.camera]->motionGate) continue;
+    CameraStream_& camera = *cameras_[entry.camera];
+    entry.unchanged = !camera.motionGate->changed(frames[b].image);
+    if (entry.unchanged) ++camera.skippedUnchanged;
+  }
+  const double takeTime = lapMilliseconds(start);
+
+  // The cameras share the forward pass, so all of them are detected if one
+  // of them or a goal needs a keyframe.
+  bool keyframe = !tracking_;
+  for (const BatchEntry_& entry : entries) {
+    if (!entry.valid || entry.unchanged) continue;
+    if (entry.camera < 0 || cameras_[entry.camera]->keyframeDue.exchange(false)) keyframe = true;
+  }
+
+  for (size_t b = 0; b < entries.size(); ++b) {
+    BatchEntry_& entry = entries[b];
+    if (!entry.valid) continue;
+    CameraStream_* camera = entry.camera < 0 ? NULL : cameras_[entry.camera].get();
+    std::fill(entry.stageTimes, entry.stageTimes + NUM_PIPELINE_STAGES, 0.);
+    entry.fetchStart = fetchStart;
+    entry.stageTimes[STAGE_FETCH] = takeTime;
+    start = std::chrono::steady_clock::now();
+
+    // The image stays valid through frames[b].source after the lock is released.
+    const cv::Mat& frame = frames[b].image;
+    if (entry.buff.w != frame.cols || entry.buff.h != frame.rows) {
+      free_image(entry.buff);
+      entry.buff = make_image(frame.cols, frame.rows, 3);
+    }
+    entry.keyframe = keyframe && !entry.unchanged;
+    entry.tiles.clear();
+    if (!entry.keyframe) {
+      // Tracked frames only need the tracker's image, unchanged frames nothing.
+    } else if (camera && tiling_) {
+      entry.tiles = tileFrame(frame.cols, frame.rows, tileColumns_, tileRows_, tileOverlap_);
+      if (tileFullFrame_) entry.tiles.insert(entry.tiles.begin(), cv::Rect(0, 0, frame.cols, frame.rows));
+      for (size_t t = 0; t < entry.tiles.size(); ++t) {
+        const cv::Rect& tile = entry.tiles[t];
+        const bool whole = tile.width == frame.cols && tile.height == frame.rows;
+        image input = float_to_image(net_->w, net_->h, net_->c, buffLetter_[slot].data + (entry.batchIndex + t) * net_->inputs);
+        letterbox_mat_into(whole ? frame : frame(tile), channelSwap_, input, whole ? &camera->letterboxPlan : &camera->tilePlan);
+      }
+    } else {
+      image input = float_to_image(net_->w, net_->h, net_->c, buffLetter_[slot].data + entry.batchIndex * net_->inputs);
+      letterbox_mat_into(frame, channelSwap_, input, camera ? &camera->letterboxPlan : &goalLetterboxPlan_);
+    }
+    entry.stageTimes[STAGE_LETTERBOX] = lapMilliseconds(start);
+    if (tracking_ && camera && !entry.unchanged) {
+      const double scale = std::min(1., static_cast<double>(trackingImageWidth_) / frame.cols);
+      cv::resize(frame, entry.trackScratch, cv::Size(), scale, scale, cv::INTER_AREA);
+      cv::cvtColor(entry.trackScratch, entry.trackImage, cv::COLOR_BGR2GRAY);
+      entry.stageTimes[STAGE_TRACK] = lapMilliseconds(start);
+    }
+    entry.bytesCopied = camera ? camera->bytesCopied.exchange(0) : 0;
+
+    // The full resolution image is only needed if the detections are drawn.
+    entry.annotated = viewImage_ || demoPrefix_ || (camera && hasDetectionImageSubscribers(*camera));
+    if (entry.annotated) {
+      mat_into_image(frame, channelSwap_, entry.buff);
+      entry.bytesCopied += entry.buff.w * entry.buff.h * entry.buff.c * sizeof(float);
+      entry.stageTimes[STAGE_FETCH] += lapMilliseconds(start);
+    } else {
+      ++skippedRenders_;
+    }
+  }
   return 0;
 }
 
-void* YoloObjectDetector::fetchInThread() {
-  {
-    boost::shared_lock<boost::shared_mutex> lock(mutexImageCallback_);
-    CvMatWithHeader_ imageAndHeader = getCvMatWithHeader();
-    free_image(buff_[buffIndex_]);
-    buff_[buffIndex_] = mat_to_image(imageAndHeader.image);
-    headerBuff_[buffIndex_] = imageAndHeader.header;
-    buffId_[buffIndex_] = actionId_;
-  }
-  rgbgr_image(buff_[buffIndex_]);
-  letterbox_image_into(buff_[buffIndex_], net_->w, net_->h, buffLetter_[buffIndex_]);
+void* YoloObjectDetector::displayInThread(int slot) {
+  for (size_t b = 0; b < batch_[slot].size(); ++b) {
+    if (!batch_[slot][b].valid) continue;
+    const int camera = batch_[slot][b].camera;
+    const std::string windowName = camera < 0 ? "YOLO check_for_objects"
+                                   : cameras_[camera]->name.empty() ? "YOLO" : "YOLO " + cameras_[camera]->name;
+    int c = show_image(batch_[slot][b].buff, windowName.c_str(), 1);
+    if (c != -1) c = c % 256;
+    if (c == 27) {
+      demoDone_ = true;
+      return 0;
+    } else if (c == 82) {
+      demoThresh_ += .02;
+    } else if (c == 84) {
+      demoThresh_ -= .02;
+      if (demoThresh_ <= .02) demoThresh_ = .02;
+    } else if (c == 83) {
+      demoHier_ += .02;
+    } else if (c == 81) {
+      demoHier_ -= .02;
+      if (demoHier_ <= .0) demoHier_ = .0;
+    }
+  }
   return 0;
 }
 
-void* YoloObjectDetector::displayInThread(void* ptr) {
-  int c = show_image(buff_[(buffIndex_ + 1) % 3], "YOLO", 1);
-  if (c != -1) c = c % 256;
-  if (c == 27) {
-    demoDone_ = 1;
-    return 0;
-  } else if (c == 82) {
-    demoThresh_ += .02;
-  } else if (c == 84) {
-    demoThresh_ -= .02;
-    if (demoThresh_ <= .02) demoThresh_ = .02;
-  } else if (c == 83) {
-    demoHier_ += .02;
-  } else if (c == 81) {
-    demoHier_ -= .02;
-    if (demoHier_ <= .0) demoHier_ = .0;
+bool YoloObjectDetector::isStale(const ros::Time& stamp) const {
+  if (latencyBudget_ <= 0 || stamp.isZero()) return false;
+  // Dropping frames cannot meet a budget below the latency of the pipeline itself.
+  const double latency = pipelineLatency_;
+  if (latency >= latencyBudget_) {
+    ROS_WARN_THROTTLE(5, "[YoloObjectDetector] Latency budget of %.3f s is below the detection latency of %.3f s.", latencyBudget_, latency);
+    return false;
+  }
+  const double age = (ros::Time::now() - stamp).toSec();
+  return age + latency > latencyBudget_;
+}
+
+void YoloObjectDetector::fetchLoop() {
+  const auto hasFrames = [this](int slot) {
+    for (const BatchEntry_& entry : batch_[slot]) {
+      if (entry.valid) return true;
+    }
+    return false;
+  };
+  int slot;
+  while (waitForSlot(freeSlots_, slot, "fetch")) {
+    // A batch whose frames were all dropped as stale keeps its slot for the next frames.
+    do {
+      if (!waitForNewFrame()) return;
+      fetchInThread(slot);
+    } while (!hasFrames(slot));
+    fetchedSlots_.push(slot);
   }
-  return 0;
 }
 
-void* YoloObjectDetector::displayLoop(void* ptr) {
-  while (1) {
-    displayInThread(0);
+bool YoloObjectDetector::waitForNewFrame() {
+  const auto hasNewFrame = [this]() {
+    for (const auto& camera : cameras_) {
+      if (camera->frameSeq != camera->fetchedFrameSeq) return true;
+    }
+    return !pendingGoals_.empty();
+  };
+  const auto waitStart = std::chrono::steady_clock::now();
+  {
+    boost::unique_lock<boost::shared_mutex> lock(mutexImageCallback_);
+    while (!hasNewFrame()) {
+      if (demoDone_) return false;
+      newFrameCondition_.wait_for(lock, boost::chrono::milliseconds(100));
+      if (!isNodeRunning()) {
+        demoDone_ = true;
+      }
+    }
   }
+  const auto waitEnd = std::chrono::steady_clock::now();
+
+  // Share of the time the detector waited for frames, smoothed over frames.
+  const double idleTime = std::chrono::duration<double>(waitEnd - waitStart).count();
+  const double frameTime = std::chrono::duration<double>(waitEnd - lastFetchTime_).count();
+  if (frameTime > 0) {
+    idleFraction_.store(.9 * idleFraction_.load() + .1 * std::min(1., idleTime / frameTime));
+  }
+  lastFetchTime_ = waitEnd;
+  ROS_DEBUG_THROTTLE(5, "[YoloObjectDetector] Detector idle %.0f%% of the time waiting for new frames.", 100 * idleFraction_.load());
+  return true;
 }
 
-void* YoloObjectDetector::detectLoop(void* ptr) {
-  while (1) {
-    detectInThread();
+void YoloObjectDetector::detectLoop() {
+  if (!inferenceCpus_.empty() && !pinInferenceThread()) {
+    ROS_WARN("[YoloObjectDetector] Could not pin the detect thread to core %d.", inferenceCpus_[0]);
+  }
+  int slot;
+  while (waitForSlot(fetchedSlots_, slot, "detect")) {
+    detectInThread(slot);
+    detectedSlots_.push(slot);
+  }
+}
+
+bool YoloObjectDetector::waitForSlot(SpscQueue<int>& queue, int& slot, const char* stageName) {
+  const auto waitStart = std::chrono::steady_clock::now();
+  bool stalled = false;
+  while (!demoDone_) {
+    if (queue.pop(slot, std::chrono::milliseconds(100))) {
+      if (stalled) {
+        ROS_INFO("[YoloObjectDetector] %s stage resumed.", stageName);
+      }
+      return true;
+    }
+    const double waitTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+    if (!stalled && waitTime > stallWarningTime_) {
+      ROS_WARN("[YoloObjectDetector] %s stage stalled, waiting for a frame slot for %.2f s.", stageName, waitTime);
+      stalled = true;
+    }
+    if (!isNodeRunning()) {
+      demoDone_ = true;
+    }
   }
+  return false;
 }
 
 void YoloObjectDetector::setupNetwork(char* cfgfile, char* weightfile, char* datafile, float thresh, char** names, int classes, int delay,
@@ -487,104 +965,247 @@ void YoloObjectDetector::setupNetwork(char* cfgfile, char* weightfile, char* dat
   demoPrefix_ = prefix;
   demoDelay_ = delay;
   demoFrame_ = avg_frames;
-  image** alphabet = load_alphabet_with_file(datafile);
   demoNames_ = names;
-  demoAlphabet_ = alphabet;
   demoClasses_ = classes;
   demoThresh_ = thresh;
   demoHier_ = hier;
   fullScreen_ = fullscreen;
+  // Same plane order as mat_to_image followed by rgbgr_image.
+  channelSwap_ = !mat_to_image_swaps_rb();
+  for (auto& camera : cameras_) {
+    camera->letterboxPlan = make_letterbox_plan();
+    camera->tilePlan = make_letterbox_plan();
+  }
   printf("YOLO\n");
-  net_ = load_network(cfgfile, weightfile, 0);
-  set_batch_network(net_, 1);
-}
-
-void YoloObjectDetector::yolo() {
-  const auto wait_duration = std::chrono::milliseconds(2000);
-  while (!getImageStatus()) {
-    printf("Waiting for image.\n");
-    if (!isNodeRunning()) {
-      return;
+  goalLetterboxPlan_ = make_letterbox_plan();
+  // All cameras, with all their tiles, and the entries reserved for action
+  // goals are detected in one forward pass.
+  const int batch = cameras_.size() * cameraBatchImages_ + actionBatchSlots_;
+  net_ = NULL;
+  if (!networkBlobPath_.empty()) {
+    std::string error;
+    net_ = loadNetworkBlob(networkBlobPath_.c_str(), batch, error);
+    if (net_) {
+      ROS_INFO("[YoloObjectDetector] Mapped network blob %s.", networkBlobPath_.c_str());
+    } else {
+      ROS_WARN("[YoloObjectDetector] Could not load network blob %s (%s), loading %s instead.", networkBlobPath_.c_str(), error.c_str(), weightfile);
+    }
+  }
+  if (!net_) {
+    net_ = loadNetworkWithBatch(cfgfile, weightfile, batch);
+  }
+  setInferenceThreads(inferenceThreads_, inferenceCpus_);
+  if (inferenceThreads_ > 1 || !inferenceCpus_.empty()) {
+    ROS_INFO("[YoloObjectDetector] Running convolutions on %d threads%s.", inferenceThreads_, inferenceCpus_.empty() ? "" : ", pinned");
+  }
+  // The node only runs inference, batch normalization is folded into the convolutions.
+  const int folded = foldBatchNorm(net_);
+  if (folded > 0) {
+    ROS_INFO("[YoloObjectDetector] Folded batch normalization into %d convolutional layers.", folded);
+  }
+  if (!int8CalibrationPath_.empty()) {
+    std::string error;
+    const int layers = quantizeNetwork(net_, listImages(int8CalibrationPath_), error);
+    if (layers >= 0) {
+      ROS_INFO("[YoloObjectDetector] Running %d convolutional layers in INT8 (%s kernels).", layers, int8KernelName());
+    } else {
+      ROS_WARN("[YoloObjectDetector] Could not calibrate INT8 inference on %s (%s), running in FP32.", int8CalibrationPath_.c_str(), error.c_str());
     }
-    std::this_thread::sleep_for(wait_duration);
   }
+}
 
-  std::thread detect_thread;
-  std::thread fetch_thread;
+void YoloObjectDetector::yolo() {
+  lastFetchTime_ = std::chrono::steady_clock::now();
 
   srand(2222222);
 
   int i;
-  demoTotal_ = sizeNetwork(net_);
-  predictions_ = (float**)calloc(demoFrame_, sizeof(float*));
-  for (i = 0; i < demoFrame_; ++i) {
-    predictions_[i] = (float*)calloc(demoTotal_, sizeof(float));
+  predictionAverager_.resize(net_, demoFrame_);
+
+  // The full resolution images are sized by the fetch stage, the network
+  // input holds one letterboxed image per camera, or its tiles, and goal.
+  const int detections = maxDetections(net_);
+  detectionArena_.resize(net_, cameraBatchImages_);
+  for (i = 0; i < 3; ++i) {
+    batch_[i].resize(cameras_.size() + actionBatchSlots_);
+    int batchIndex = 0;
+    for (size_t b = 0; b < batch_[i].size(); ++b) {
+      BatchEntry_& entry = batch_[i][b];
+      const int images = b < cameras_.size() ? cameraBatchImages_ : 1;
+      entry.buff = make_empty_image(0, 0, 3);
+      entry.roiBoxCapacity = detections * images;
+      entry.roiBoxes = (darknet_ros::RosBox_*)calloc(entry.roiBoxCapacity + 1, sizeof(darknet_ros::RosBox_));
+      entry.batchIndex = batchIndex;
+      batchIndex += images;
+    }
+    buffLetter_[i] = make_image(net_->w, net_->h, net_->c * net_->batch);
   }
-  avg_ = (float*)calloc(demoTotal_, sizeof(float));
-
-  layer l = net_->layers[net_->n - 1];
-  roiBoxes_ = (darknet_ros::RosBox_*)calloc(l.w * l.h * l.n, sizeof(darknet_ros::RosBox_));
-
-  {
-    boost::shared_lock<boost::shared_mutex> lock(mutexImageCallback_);
-    CvMatWithHeader_ imageAndHeader = getCvMatWithHeader();
-    buff_[0] = mat_to_image(imageAndHeader.image);
-    headerBuff_[0] = imageAndHeader.header;
-  }
-  buff_[1] = copy_image(buff_[0]);
-  buff_[2] = copy_image(buff_[0]);
-  headerBuff_[1] = headerBuff_[0];
-  headerBuff_[2] = headerBuff_[0];
-  buffLetter_[0] = letterbox_image(buff_[0], net_->w, net_->h);
-  buffLetter_[1] = letterbox_image(buff_[0], net_->w, net_->h);
-  buffLetter_[2] = letterbox_image(buff_[0], net_->w, net_->h);
-  disp_ = image_to_mat(buff_[0]);
 
   int count = 0;
   if (!demoPrefix_ && viewImage_) {
-    cv::namedWindow("YOLO", cv::WINDOW_NORMAL);
-    if (fullScreen_) {
-      cv::setWindowProperty("YOLO", cv::WND_PROP_FULLSCREEN, cv::WINDOW_FULLSCREEN);
-    } else {
-      cv::moveWindow("YOLO", 0, 0);
-      cv::resizeWindow("YOLO", 640, 480);
+    for (size_t b = 0; b < cameras_.size(); ++b) {
+      const std::string windowName = cameras_[b]->name.empty() ? "YOLO" : "YOLO " + cameras_[b]->name;
+      cv::namedWindow(windowName, cv::WINDOW_NORMAL);
+      if (fullScreen_) {
+        cv::setWindowProperty(windowName, cv::WND_PROP_FULLSCREEN, cv::WINDOW_FULLSCREEN);
+      } else {
+        cv::moveWindow(windowName, 640 * b, 0);
+        cv::resizeWindow(windowName, 640, 480);
+      }
     }
   }
 
+  printf("Waiting for image.\n");
   demoTime_ = what_time_is_it_now();
 
-  while (!demoDone_) {
-    buffIndex_ = (buffIndex_ + 1) % 3;
-    fetch_thread = std::thread(&YoloObjectDetector::fetchInThread, this);
-    detect_thread = std::thread(&YoloObjectDetector::detectInThread, this);
+  // Keep up to three frames in flight: one being fetched, one detected and one published.
+  for (i = 0; i < 3; ++i) {
+    freeSlots_.push(i);
+  }
+  fetchThread_ = std::thread(&YoloObjectDetector::fetchLoop, this);
+  detectThread_ = std::thread(&YoloObjectDetector::detectLoop, this);
+
+  int slot;
+  while (waitForSlot(detectedSlots_, slot, "publish")) {
     if (!demoPrefix_) {
       fps_ = 1. / (what_time_is_it_now() - demoTime_);
       demoTime_ = what_time_is_it_now();
       if (viewImage_) {
-        displayInThread(0);
-      } else {
-        generate_image(buff_[(buffIndex_ + 1) % 3], disp_);
+        displayInThread(slot);
+      }
+      for (size_t b = 0; b < batch_[slot].size(); ++b) {
+        BatchEntry_& entry = batch_[slot][b];
+        if (!entry.valid) continue;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (entry.camera < 0) {
+          publishActionResult(slot, b);
+        } else {
+          CameraStream_& camera = *cameras_[entry.camera];
+          // Decided once, subscribers connecting after this wait for the next frame.
+          const bool rendered = entry.annotated && hasDetectionImageSubscribers(camera);
+          if (rendered) {
+            camera.disp.create(entry.buff.h, entry.buff.w, CV_8UC3);
+            generate_image(entry.buff, camera.disp, conversionThreads_);
+            entry.stageTimes[STAGE_RENDER] += lapMilliseconds(start);
+          }
+          publishInThread(slot, b, rendered);
+          publishFrameFreshness(camera, entry);
+        }
+        // publishInThread times the depth association on its own. The total
+        // runs until the frame and its freshness are published.
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        entry.stageTimes[STAGE_PUBLISH] = std::chrono::duration<double, std::milli>(end - start).count() - entry.stageTimes[STAGE_DEPTH];
+        entry.stageTimes[STAGE_TOTAL] = std::chrono::duration<double, std::milli>(end - entry.fetchStart).count();
+        recordStageTimes(entry);
       }
-      publishInThread();
     } else {
-      char name[256];
-      sprintf(name, "%s_%08d", demoPrefix_, count);
-      save_image(buff_[(buffIndex_ + 1) % 3], name);
+      for (size_t b = 0; b < batch_[slot].size(); ++b) {
+        if (!batch_[slot][b].valid) continue;
+        char name[256];
+        sprintf(name, "%s_%08d_%zu", demoPrefix_, count, b);
+        save_image(batch_[slot][b].buff, name);
+      }
     }
-    fetch_thread.join();
-    detect_thread.join();
+    freeSlots_.push(slot);
     ++count;
     if (!isNodeRunning()) {
       demoDone_ = true;
     }
   }
+
+  fetchThread_.join();
+  detectThread_.join();
 }
 
-CvMatWithHeader_ YoloObjectDetector::getCvMatWithHeader() {
-  CvMatWithHeader_ header = {.image = camImageCopy_, .header = imageHeader_};
+CvMatWithHeader_ YoloObjectDetector::getCvMatWithHeader(const CameraStream_& camera) {
+  CvMatWithHeader_ header = {.image = camera.camImageCopy, .header = camera.imageHeader, .source = camera.camImage,
+                             .depth = camera.depthImage, .depthSource = camera.camDepth};
   return header;
 }
 
+void YoloObjectDetector::publishFrameFreshness(CameraStream_& camera, const BatchEntry_& entry) {
+  const ros::Time now = ros::Time::now();
+  pipelineLatency_ = .9 * pipelineLatency_ + .1 * (now - entry.fetchTime).toSec();
+
+  darknet_ros_msgs::FrameFreshness msg;
+  msg.header.stamp = now;
+  msg.header.frame_id = "detection";
+  msg.image_header = entry.header;
+  msg.age = entry.header.stamp.isZero() ? 0 : (now - entry.header.stamp).toSec();
+  msg.latency_budget = latencyBudget_;
+  if (latencyBudget_ > 0 && msg.age > latencyBudget_) {
+    ++camera.overBudget;
+  }
+  msg.dropped_stale = camera.droppedStale;
+  msg.dropped_superseded = camera.droppedSuperseded;
+  msg.over_budget = camera.overBudget;
+  msg.skipped_unchanged = camera.skippedUnchanged;
+  camera.frameFreshnessPublisher.publish(msg);
+}
+
+void YoloObjectDetector::recordStageTimes(const BatchEntry_& entry) {
+  std::lock_guard<std::mutex> lock(mutexStatistics_);
+  for (int stage = 0; stage < NUM_PIPELINE_STAGES; ++stage) {
+    stageLatencies_[stage].add(entry.stageTimes[stage]);
+  }
+}
+
+void YoloObjectDetector::publishPipelineStatistics(const ros::WallTimerEvent& event) {
+  if (pipelineStatisticsPublisher_.getNumSubscribers() > 0) {
+    darknet_ros_msgs::PipelineStatistics msg;
+    msg.header.stamp = ros::Time::now();
+    msg.header.frame_id = "detection";
+    msg.stages.resize(NUM_PIPELINE_STAGES);
+    {
+      std::lock_guard<std::mutex> lock(mutexStatistics_);
+      msg.window = stageLatencies_[STAGE_TOTAL].count();
+      for (int stage = 0; stage < NUM_PIPELINE_STAGES; ++stage) {
+        const LatencyHistogram& latencies = stageLatencies_[stage];
+        darknet_ros_msgs::StageLatency& stageMsg = msg.stages[stage];
+        stageMsg.name = pipelineStageNames[stage];
+        stageMsg.count = latencies.count();
+        stageMsg.mean = latencies.mean();
+        stageMsg.p50 = latencies.percentile(50, percentileScratch_);
+        stageMsg.p95 = latencies.percentile(95, percentileScratch_);
+        stageMsg.p99 = latencies.percentile(99, percentileScratch_);
+        stageMsg.max = latencies.max();
+        stageMsg.bucket_bounds = LatencyHistogram::bounds();
+        stageMsg.bucket_counts = latencies.counts();
+      }
+    }
+    pipelineStatisticsPublisher_.publish(msg);
+  }
+  // The updater limits itself to its own period.
+  diagnosticUpdater_.update();
+}
+
+void YoloObjectDetector::pipelineDiagnostics(diagnostic_updater::DiagnosticStatusWrapper& status) {
+  std::lock_guard<std::mutex> lock(mutexStatistics_);
+  const LatencyHistogram& total = stageLatencies_[STAGE_TOTAL];
+  if (total.count() == 0) {
+    status.summary(diagnostic_msgs::DiagnosticStatus::OK, "Waiting for frames.");
+    return;
+  }
+  const double p95 = total.percentile(95, percentileScratch_);
+  if (latencyBudget_ > 0 && p95 > 1000 * latencyBudget_) {
+    status.summaryf(diagnostic_msgs::DiagnosticStatus::WARN, "p95 latency of %.1f ms exceeds the latency budget.", p95);
+  } else {
+    status.summaryf(diagnostic_msgs::DiagnosticStatus::OK, "p95 latency of %.1f ms.", p95);
+  }
+  status.add("Frames", total.count());
+  for (int stage = 0; stage < NUM_PIPELINE_STAGES; ++stage) {
+    const LatencyHistogram& latencies = stageLatencies_[stage];
+    status.addf(std::string(pipelineStageNames[stage]) + " p50/p95/p99 [ms]", "%.2f / %.2f / %.2f", latencies.percentile(50, percentileScratch_),
+                latencies.percentile(95, percentileScratch_), latencies.percentile(99, percentileScratch_));
+  }
+  status.add("Skipped renders", skippedRenders_.load());
+  if (cameras_[0]->motionGate) {
+    uint32_t skippedUnchanged = 0;
+    for (const auto& camera : cameras_) skippedUnchanged += camera->skippedUnchanged;
+    status.add("Skipped unchanged frames", skippedUnchanged);
+  }
+}
+
 bool YoloObjectDetector::getImageStatus(void) {
   boost::shared_lock<boost::shared_mutex> lock(mutexImageStatus_);
   return imageStatus_;
@@ -595,133 +1216,105 @@ bool YoloObjectDetector::isNodeRunning(void) {
   return isNodeRunning_;
 }
 
-void* YoloObjectDetector::publishInThread() {
+int YoloObjectDetector::collectBoundingBoxes(const BatchEntry_& entry, std::vector<darknet_ros_msgs::BoundingBox>& boundingBoxes) {
+  const int num = std::max(entry.roiBoxes[0].num, 0);
+  return fillBoundingBoxes(entry.roiBoxes, num, entry.buff.w, entry.buff.h, classLabels_, tracking_ && entry.camera >= 0, boundingBoxes);
+}
+
+void* YoloObjectDetector::publishInThread(int slot, size_t index, bool rendered) {
+  BatchEntry_& entry = batch_[slot][index];
+  CameraStream_& camera = *cameras_[entry.camera];
+  ROS_DEBUG("[YoloObjectDetector] Frame %u copied %zu bytes up to the network input.", entry.header.seq, entry.bytesCopied);
+
   // Publish image.
-  cv::Mat cvImage = disp_;
-  if (!publishDetectionImage(cv::Mat(cvImage))) {
+  cv::Mat cvImage = camera.disp;
+  if (!rendered || !publishDetectionImage(camera, cv::Mat(cvImage))) {
     ROS_DEBUG("Detection image has not been broadcasted.");
   }
 
-  // Publish bounding boxes and detection result.
-  int num = roiBoxes_[0].num;
-  if (num > 0 && num <= 100) {
-    for (int i = 0; i < num; i++) {
-      for (int j = 0; j < numClasses_; j++) {
-        if (roiBoxes_[i].Class == j) {
-          rosBoxes_[j].push_back(roiBoxes_[i]);
-          rosBoxCounter_[j]++;
-        }
-      }
+  // Publish bounding boxes and detection result. The messages are published
+  // as pointers, so nodelets in the process share them without a copy.
+  darknet_ros_msgs::BoundingBoxesPtr& boundingBoxes = recycleMessage(camera.boundingBoxes);
+  const int num = collectBoundingBoxes(entry, boundingBoxes->bounding_boxes);
+  darknet_ros_msgs::ObjectCount msg;
+  msg.header.stamp = ros::Time::now();
+  msg.header.frame_id = "detection";
+  msg.count = num;
+  camera.objectPublisher.publish(msg);
+  if (num > 0) {
+    //For depth inclusion
+    std::chrono::steady_clock::time_point depthStart = std::chrono::steady_clock::now();
+    darknet_ros_msgs::FrameDepthPtr& frameDepth = recycleMessage(camera.frameDepth);
+    frameDepth->objDepths.resize(num);
+    depthBoxes_.resize(num);
+    boxDepths_.resize(num);
+    for (int i = 0; i < num; ++i) {
+      const darknet_ros_msgs::BoundingBox& bbox = boundingBoxes->bounding_boxes[i];
+      depthBoxes_[i] = cv::Rect(bbox.xmin, bbox.ymin, bbox.xmax - bbox.xmin, bbox.ymax - bbox.ymin);
     }
-
-    darknet_ros_msgs::ObjectCount msg;
-    msg.header.stamp = ros::Time::now();
-    msg.header.frame_id = "detection";
-    msg.count = num;
-    objectPublisher_.publish(msg);
-
-
-
-
-    for (int i = 0; i < numClasses_; i++) {
-      if (rosBoxCounter_[i] > 0) {
-        darknet_ros_msgs::BoundingBox boundingBox;
-        darknet_ros_msgs::ObjDepth objDepthMsg;   //can use pointers here to reduce multiple objects
-
-        for (int j = 0; j < rosBoxCounter_[i]; j++) 
-        {
-          int xmin = (rosBoxes_[i][j].x - rosBoxes_[i][j].w / 2) * frameWidth_;
-          int ymin = (rosBoxes_[i][j].y - rosBoxes_[i][j].h / 2) * frameHeight_;
-          int xmax = (rosBoxes_[i][j].x + rosBoxes_[i][j].w / 2) * frameWidth_;
-          int ymax = (rosBoxes_[i][j].y + rosBoxes_[i][j].h / 2) * frameHeight_;
-
-          boundingBox.Class = classLabels_[i];
-          boundingBox.id = i;
-          boundingBox.probability = rosBoxes_[i][j].prob;
-          boundingBox.xmin = xmin;
-          boundingBox.ymin = ymin;
-          boundingBox.xmax = xmax;
-          boundingBox.ymax = ymax;
-          boundingBoxesResults_.bounding_boxes.push_back(boundingBox);
-
-          //For depth inclusion
-          objDepthMsg = associateDepth(boundingBox, objDepthMsg);
-          DepthMsg_.objDepths.push_back(objDepthMsg);
-        }
-      }
+    depthEstimator_->estimate(entry.depth, depthBoxes_.data(), num, boxDepths_.data());
+    for (int i = 0; i < num; ++i) {
+      associateDepth(camera, boundingBoxes->bounding_boxes[i], boxDepths_[i], frameDepth->objDepths[i]);
     }
-    boundingBoxesResults_.header.stamp = ros::Time::now();
-    boundingBoxesResults_.header.frame_id = "detection";
-    boundingBoxesResults_.image_header = headerBuff_[(buffIndex_ + 1) % 3];
-    boundingBoxesPublisher_.publish(boundingBoxesResults_);
+    entry.stageTimes[STAGE_DEPTH] = lapMilliseconds(depthStart);
+
+    boundingBoxes->header.stamp = ros::Time::now();
+    boundingBoxes->header.frame_id = "detection";
+    boundingBoxes->image_header = entry.header;
+    camera.boundingBoxesPublisher.publish(boundingBoxes);
 
     //DepthFrame Message Wrapper 
-    DepthMsg_.header.stamp = ros::Time::now(); 
-    DepthMsg_.header.frame_id = depth_frame_;
-    DepthMsg_.objCount = msg.count;
-    sceneDepthPublisher_.publish(DepthMsg_);
+    frameDepth->header.stamp = ros::Time::now(); 
+    frameDepth->header.frame_id = camera.depthFrame;
+    frameDepth->objCount = num;
+    camera.sceneDepthPublisher.publish(frameDepth);
 
     //publish Depth Detection Image
-    if (!publishDepthTaggedDetectionImage(cv::Mat(cvImage), darknet_ros_msgs::FrameDepth(DepthMsg_))) {
+    if (!rendered || !publishDepthTaggedDetectionImage(camera, cv::Mat(cvImage), *frameDepth)) {
       ROS_DEBUG("Depth Tagged Detection image has not been broadcasted.");
     }
-  
-    DepthMsg_.objDepths.clear();
-  } else {
-    darknet_ros_msgs::ObjectCount msg;
-    msg.header.stamp = ros::Time::now();
-    msg.header.frame_id = "detection";
-    msg.count = 0;
-    objectPublisher_.publish(msg);
-  }
-  if (isCheckingForObjects()) {
-    ROS_DEBUG("[YoloObjectDetector] check for objects in image.");
-    darknet_ros_msgs::CheckForObjectsResult objectsActionResult;
-    objectsActionResult.id = buffId_[0];
-    objectsActionResult.bounding_boxes = boundingBoxesResults_;
-    checkForObjectsActionServer_->setSucceeded(objectsActionResult, "Send bounding boxes.");
-  }
-  boundingBoxesResults_.bounding_boxes.clear();
-  for (int i = 0; i < numClasses_; i++) {
-    rosBoxes_[i].clear();
-    rosBoxCounter_[i] = 0;
   }
 
+  // The depth message goes back to the driver before the slot comes around again.
+  entry.depth.release();
+  entry.depthSource.reset();
   return 0;
 }
 
-darknet_ros_msgs::ObjDepth YoloObjectDetector::associateDepth(const darknet_ros_msgs::BoundingBox& bbox, darknet_ros_msgs::ObjDepth ObjDepthMsg)
-{
-  /*
-  Depth image ROS REP : https://www.ros.org/reps/rep-0118.html
-
-  Formula for calculating X,Y in camera frame (Z in front (Depth), X is up, y is right (toward USB-C))
-  Xreal = (u - cx) * Z / fx;
-  Yreal = (v - cy) * Z / fy; 
-  Zreal = Z
-
-  u, v   = Desired pixel values
-  cx, cy = Intrinsic camera parameter (Principal points)
-  fx, fy = Intrinsic camera parameter (Focal lengths)
-  Z      = Depth of (u, v) from camera
-
-  */
+void YoloObjectDetector::publishActionResult(int slot, size_t index) {
+  const BatchEntry_& entry = batch_[slot][index];
+  CheckForObjectsGoalHandle goal = entry.goal.goal;
+  // Goals canceled while being detected get no result.
+  if (goal.getGoalStatus().status != actionlib_msgs::GoalStatus::ACTIVE) return;
+
+  ROS_DEBUG("[YoloObjectDetector] check for objects in image.");
+  darknet_ros_msgs::CheckForObjectsResult objectsActionResult;
+  collectBoundingBoxes(entry, objectsActionResult.bounding_boxes.bounding_boxes);
+  objectsActionResult.id = goal.getGoal()->id;
+  objectsActionResult.bounding_boxes.header.stamp = ros::Time::now();
+  objectsActionResult.bounding_boxes.header.frame_id = "detection";
+  objectsActionResult.bounding_boxes.image_header = entry.header;
+  objectsActionResult.latency = (ros::Time::now() - entry.goal.acceptTime).toSec();
+  goal.setSucceeded(objectsActionResult, "Send bounding boxes.");
+}
 
+void YoloObjectDetector::associateDepth(const CameraStream_& camera, const darknet_ros_msgs::BoundingBox& bbox, float depth, darknet_ros_msgs::ObjDepth& ObjDepthMsg)
+{
   try
   {
 
     int u = static_cast<int>((bbox.xmin+bbox.xmax)/2); 
     int v = static_cast<int>((bbox.ymin+bbox.ymax)/2);
-    // float Z =static_cast<float>(0.001*depthImageCopy_.at<u_int16_t>(v, u));  //FOR 16UC1 (values in m)'
-    float Z = 0.001*depthImageCopy_.at<u_int16_t>(v, u);
+    // Cameras without depth report objects at zero depth.
+    const cv::Point3f position = backProject(camera.intrinsics, u, v, 0.001 * depth);
 
     //class name, type
     ObjDepthMsg.objID = bbox.id;
     ObjDepthMsg.className = bbox.Class;
     ObjDepthMsg.classType = "To be decided";
-    ObjDepthMsg.objDepth = round(Z*1000.0)/1000.0 ; 
-    ObjDepthMsg.objX = round((u - intrin_cx_) * Z * 1000.0 / intrin_fx_ ) / 1000.0; 
-    ObjDepthMsg.objY = round((v - intrin_cy_) * Z * 1000.0 / intrin_fy_ ) / 1000.0;
+    ObjDepthMsg.objDepth = round(position.z * 1000.0) / 1000.0;
+    ObjDepthMsg.objX = round(position.x * 1000.0) / 1000.0;
+    ObjDepthMsg.objY = round(position.y * 1000.0) / 1000.0;
     ObjDepthMsg.bbox_center_u = u; 
     ObjDepthMsg.bbox_center_v = v;
 
@@ -730,37 +1323,37 @@ darknet_ros_msgs::ObjDepth YoloObjectDetector::associateDepth(const darknet_ros_
   {
     ROS_ERROR("Some Error occurred!");
   }
-
-  return ObjDepthMsg;
-
 }
 
-void YoloObjectDetector::cameraDepthInfoCallback(const sensor_msgs::CameraInfoPtr& depthInfoMsg)
+void YoloObjectDetector::cameraDepthInfoCallback(const sensor_msgs::CameraInfoConstPtr& depthInfoMsg, size_t index)
 {
+  CameraStream_& camera = *cameras_[index];
   if (depthInfoMsg->distortion_model == "plumb_bob") //RS has a plumb_bob model 
   {
-    depth_frame_ = depthInfoMsg->header.frame_id;
-    intrin_fx_   = depthInfoMsg->K[0];
-    intrin_fy_   = depthInfoMsg->K[4];
-    intrin_cx_   = depthInfoMsg->K[2];
-    intrin_cy_   = depthInfoMsg->K[5];
+    camera.depthFrame = depthInfoMsg->header.frame_id;
+    camera.intrinsics.fx = depthInfoMsg->K[0];
+    camera.intrinsics.fy = depthInfoMsg->K[4];
+    camera.intrinsics.cx = depthInfoMsg->K[2];
+    camera.intrinsics.cy = depthInfoMsg->K[5];
   }
 }
 
-bool YoloObjectDetector::publishDepthTaggedDetectionImage(const cv::Mat& incomingImage,const darknet_ros_msgs::FrameDepth& frameDepthMsg)
+bool YoloObjectDetector::publishDepthTaggedDetectionImage(CameraStream_& camera, const cv::Mat& incomingImage,const darknet_ros_msgs::FrameDepth& frameDepthMsg)
 {
   // std::cout << "attempt to publish Depth tagged detections" << std::endl;
-  // if (YoloObjectDetector::depthTaggedDetectionImagePublisher_.getNumSubscribers() < 1) return false;
+  if (camera.depthTaggedDetectionImagePublisher.getNumSubscribers() < 1) return false;
   //create CV image
   cv_bridge::CvImage cvImage; 
   cvImage.header.stamp = ros::Time::now();
   cvImage.header.frame_id = "depth_tagged_detection_image";
   cvImage.encoding = sensor_msgs::image_encodings::RGB8; 
-  cvImage.image = incomingImage;
+  // The labels are drawn on a buffer of the camera, not on the detection image.
+  incomingImage.copyTo(camera.depthTaggedDisp);
+  cvImage.image = camera.depthTaggedDisp;
   //draw here 
   if (frameDepthMsg.objCount > 0)
   {
-    for (auto objDepth : frameDepthMsg.objDepths){
+    for (const auto& objDepth : frameDepthMsg.objDepths){
       std::string disp_string = "X:" + std::to_string(objDepth.objX) 
                               + "Y:" + std::to_string(objDepth.objY)
                               + "Z:" + std::to_string(objDepth.objDepth);
@@ -768,10 +1361,10 @@ bool YoloObjectDetector::publishDepthTaggedDetectionImage(const cv::Mat& incomin
       int font_size = 1; 
       cv::Scalar font_color(0,0,0); 
       int font_weight = 2; 
-      cv::putText(incomingImage, disp_string, text_pos, cv::FONT_HERSHEY_SIMPLEX, 0.5, font_color, 2);
+      cv::putText(camera.depthTaggedDisp, disp_string, text_pos, cv::FONT_HERSHEY_SIMPLEX, 0.5, font_color, 2);
     }
   }
-  depthTaggedDetectionImagePublisher_.publish(*cvImage.toImageMsg());
+  camera.depthTaggedDetectionImagePublisher.publish(*cvImage.toImageMsg());
   ROS_DEBUG("Depth tagged detection image has been published.");
   return true;
 }
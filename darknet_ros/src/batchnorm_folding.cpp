@@ -0,0 +1,99 @@
+/*
+ * batchnorm_folding.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/batchnorm_folding.hpp"
+
+// c++
+#include <algorithm>
+#include <cmath>
+
+// Darknet.
+extern "C" {
+#include "activations.h"
+#include "convolutional_layer.h"
+#include "gemm.h"
+#include "im2col.h"
+}
+
+// Inference threads.
+#include "darknet_ros/inference_threads.hpp"
+
+namespace darknet_ros {
+
+namespace {
+
+// forward_convolutional_layer of a layer without batch normalization. The
+// GEMM accumulates onto the biases instead of zeros, and each output block is
+// activated right after it is computed. The loops are split over the
+// inference threads.
+void forwardConvolutionalFolded(layer l, network net) {
+  const int m = l.n / l.groups;
+  const int k = l.size * l.size * l.c / l.groups;
+  const int n = l.out_w * l.out_h;
+  const int channels = l.c / l.groups;
+  for (int b = 0; b < l.batch; ++b) {
+    for (int g = 0; g < l.groups; ++g) {
+      float* output = l.output + static_cast<size_t>(b * l.groups + g) * n * m;
+      const float* biases = l.biases + g * m;
+      float* weights = l.weights + static_cast<size_t>(g) * l.nweights / l.groups;
+      float* input = net.input + static_cast<size_t>(b * l.groups + g) * channels * l.h * l.w;
+      float* columns = input;
+      if (l.size != 1) {
+        // The rows of each input channel are contiguous in the columns.
+        columns = net.workspace;
+        parallelFor(channels, [&](int c0, int c1) {
+          im2col_cpu(input + static_cast<size_t>(c0) * l.h * l.w, c1 - c0, l.h, l.w, l.size, l.stride, l.pad,
+                     columns + static_cast<size_t>(c0) * l.size * l.size * n);
+        });
+      }
+      // Early layers have few filters and many pixels, late layers the other
+      // way round, so the threads split whichever has enough to go around.
+      if (m >= 4 * inferenceThreads()) {
+        parallelFor(m, [&](int i0, int i1) {
+          float* rows = output + static_cast<size_t>(i0) * n;
+          for (int i = i0; i < i1; ++i) std::fill(output + static_cast<size_t>(i) * n, output + static_cast<size_t>(i + 1) * n, biases[i]);
+          gemm(0, 0, i1 - i0, n, k, 1, weights + static_cast<size_t>(i0) * k, k, columns, n, 1, rows, n);
+          activate_array(rows, (i1 - i0) * n, l.activation);
+        });
+      } else {
+        parallelFor(n, [&](int j0, int j1) {
+          for (int i = 0; i < m; ++i) std::fill(output + static_cast<size_t>(i) * n + j0, output + static_cast<size_t>(i) * n + j1, biases[i]);
+          gemm(0, 0, m, j1 - j0, k, 1, weights, k, columns + j0, n, 1, output + j0, n);
+          for (int i = 0; i < m; ++i) activate_array(output + static_cast<size_t>(i) * n + j0, j1 - j0, l.activation);
+        });
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int foldBatchNorm(network* net) {
+  int folded = 0;
+  for (int i = 0; i < net->n; ++i) {
+    layer& l = net->layers[i];
+    if (l.type != CONVOLUTIONAL || l.binary || l.xnor) continue;
+    if (l.batch_normalize) {
+      // Same epsilon as darknet's normalize_cpu.
+      const int size = l.nweights / l.n;
+      for (int f = 0; f < l.n; ++f) {
+        const float factor = l.scales[f] / (std::sqrt(l.rolling_variance[f]) + .000001f);
+        for (int w = 0; w < size; ++w) l.weights[f * size + w] *= factor;
+        l.biases[f] -= l.rolling_mean[f] * factor;
+      }
+      l.batch_normalize = 0;
+#ifdef GPU
+      if (gpu_index >= 0) push_convolutional_layer(l);
+#endif
+      ++folded;
+    }
+    l.forward = forwardConvolutionalFolded;
+  }
+  return folded;
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,32 @@
+/*
+ * box_messages.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/box_messages.hpp"
+
+namespace darknet_ros {
+
+int fillBoundingBoxes(const RosBox_* boxes, int count, int frameWidth, int frameHeight, const std::vector<std::string>& classLabels,
+                      bool trackIds, std::vector<darknet_ros_msgs::BoundingBox>& boundingBoxes) {
+  boundingBoxes.resize(count);
+  int num = 0;
+  for (int i = 0; i < count; ++i) {
+    const RosBox_& box = boxes[i];
+    if (box.Class < 0 || box.Class >= static_cast<int>(classLabels.size())) continue;
+    darknet_ros_msgs::BoundingBox& boundingBox = boundingBoxes[num++];
+    boundingBox.Class = classLabels[box.Class];
+    boundingBox.id = trackIds ? box.id : box.Class;
+    boundingBox.probability = box.prob;
+    boundingBox.xmin = static_cast<int>((box.x - box.w / 2) * frameWidth);
+    boundingBox.ymin = static_cast<int>((box.y - box.h / 2) * frameHeight);
+    boundingBox.xmax = static_cast<int>((box.x + box.w / 2) * frameWidth);
+    boundingBox.ymax = static_cast<int>((box.y + box.h / 2) * frameHeight);
+  }
+  boundingBoxes.resize(num);
+  return num;
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,119 @@
+/*
+ * box_postprocessing.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/box_postprocessing.hpp"
+
+// c++
+#include <algorithm>
+
+namespace darknet_ros {
+
+void BoxArrays_::clear() {
+  x.clear();
+  y.clear();
+  w.clear();
+  h.clear();
+  prob.clear();
+  Class.clear();
+}
+
+void BoxArrays_::push_back(float boxX, float boxY, float boxW, float boxH, float boxProb, int boxClass) {
+  x.push_back(boxX);
+  y.push_back(boxY);
+  w.push_back(boxW);
+  h.push_back(boxH);
+  prob.push_back(boxProb);
+  Class.push_back(boxClass);
+}
+
+int BoxPostprocessor::run(const detection* dets, int nboxes, int classes, float thresh, float nmsThresh) {
+  candidates_.clear();
+  classStarts_.assign(classes + 1, 0);
+  for (int i = 0; i < nboxes; ++i) {
+    if (dets[i].objectness <= thresh) continue;
+    const float* prob = dets[i].prob;
+    for (int j = 0; j < classes; ++j) {
+      if (prob[j] > 0) {
+        candidates_.push_back(Candidate{prob[j], i, j});
+        ++classStarts_[j + 1];
+      }
+    }
+  }
+
+  // Counting sort by class, then by probability within each class.
+  for (int j = 0; j < classes; ++j) classStarts_[j + 1] += classStarts_[j];
+  sorted_.resize(candidates_.size());
+  for (const Candidate& candidate : candidates_) sorted_[classStarts_[candidate.Class]++] = candidate;
+  for (int j = classes; j > 0; --j) classStarts_[j] = classStarts_[j - 1];
+  classStarts_[0] = 0;
+
+  boxes_.clear();
+  for (int j = 0; j < classes; ++j) {
+    const auto begin = sorted_.begin() + classStarts_[j];
+    const auto end = sorted_.begin() + classStarts_[j + 1];
+    if (begin == end) continue;
+    // Ties keep the order of the detections.
+    std::sort(begin, end, [](const Candidate& a, const Candidate& b) { return a.prob > b.prob || (a.prob == b.prob && a.det < b.det); });
+
+    left_.clear();
+    top_.clear();
+    right_.clear();
+    bottom_.clear();
+    area_.clear();
+    for (auto candidate = begin; candidate != end; ++candidate) {
+      const box& b = dets[candidate->det].bbox;
+      const float left = b.x - b.w / 2;
+      const float top = b.y - b.h / 2;
+      const float right = b.x + b.w / 2;
+      const float bottom = b.y + b.h / 2;
+      const float area = b.w * b.h;
+      // Suppressed by the first kept box it overlaps enough.
+      bool suppressed = false;
+      for (size_t k = 0; k < area_.size(); ++k) {
+        const float overlapW = std::min(right, right_[k]) - std::max(left, left_[k]);
+        const float overlapH = std::min(bottom, bottom_[k]) - std::max(top, top_[k]);
+        if (overlapW <= 0 || overlapH <= 0) continue;
+        const float intersection = overlapW * overlapH;
+        if (intersection > nmsThresh * (area + area_[k] - intersection)) {
+          suppressed = true;
+          break;
+        }
+      }
+      if (suppressed) continue;
+      left_.push_back(left);
+      top_.push_back(top);
+      right_.push_back(right);
+      bottom_.push_back(bottom);
+      area_.push_back(area);
+      boxes_.push_back(b.x, b.y, b.w, b.h, candidate->prob, j);
+    }
+  }
+  return boxes_.size();
+}
+
+int BoxPostprocessor::extract(RosBox_* boxes, int capacity) const {
+  int count = 0;
+  for (size_t i = 0; i < boxes_.size() && count < capacity; ++i) {
+    const float xmin = std::max(boxes_.x[i] - boxes_.w[i] / 2, 0.f);
+    const float xmax = std::min(boxes_.x[i] + boxes_.w[i] / 2, 1.f);
+    const float ymin = std::max(boxes_.y[i] - boxes_.h[i] / 2, 0.f);
+    const float ymax = std::min(boxes_.y[i] + boxes_.h[i] / 2, 1.f);
+    // BoundingBox must be 1% size of frame (3.2x2.4 pixels)
+    if (xmax - xmin <= 0.01 || ymax - ymin <= 0.01) continue;
+    RosBox_& roiBox = boxes[count++];
+    roiBox.x = (xmin + xmax) / 2;
+    roiBox.y = (ymin + ymax) / 2;
+    roiBox.w = xmax - xmin;
+    roiBox.h = ymax - ymin;
+    roiBox.Class = boxes_.Class[i];
+    roiBox.prob = boxes_.prob[i];
+  }
+  boxes[0].num = count;
+  return count;
+}
+
+} /* namespace darknet_ros*/
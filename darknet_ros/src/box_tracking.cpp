@@ -0,0 +1,195 @@
+/*
+ * box_tracking.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/box_tracking.hpp"
+
+// c++
+#include <algorithm>
+#include <cmath>
+
+// OpenCv
+#include <opencv2/video/tracking.hpp>
+
+namespace darknet_ros {
+
+namespace {
+
+// Grid of points followed per box.
+const int kPointsPerSide = 5;
+
+// Points whose flow back to the previous frame misses their start by more than this are lost [pixels].
+const float kMaxForwardBackwardError = 1.f;
+
+// A detection continues a track of its class if they overlap at least this much.
+const float kMinTrackIou = .3f;
+
+// Ids fit the int16 id of darknet_ros_msgs/BoundingBox.
+const int kMaxTrackId = 32767;
+
+float median(std::vector<float>& values) {
+  const size_t middle = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + middle, values.end());
+  return values[middle];
+}
+
+}  // namespace
+
+BoxTracker::BoxTracker(int minInterval, int maxInterval, double minConfidence)
+    : nextId_(0),
+      minInterval_(std::max(minInterval, 1)),
+      maxInterval_(std::max(maxInterval, std::max(minInterval, 1))),
+      interval_(minInterval_),
+      framesSinceKeyframe_(0),
+      minConfidence_(minConfidence),
+      lost_(false) {}
+
+void BoxTracker::seedPoints(Track& track, int w, int h) {
+  // The inner part of the box, its border is mostly background.
+  const float x0 = (track.box.x - .4f * track.box.w) * w;
+  const float y0 = (track.box.y - .4f * track.box.h) * h;
+  const float stepX = .8f * track.box.w * w / (kPointsPerSide - 1);
+  const float stepY = .8f * track.box.h * h / (kPointsPerSide - 1);
+  track.points.clear();
+  for (int i = 0; i < kPointsPerSide; ++i) {
+    for (int j = 0; j < kPointsPerSide; ++j) {
+      const float x = std::min(std::max(x0 + j * stepX, 0.f), w - 1.f);
+      const float y = std::min(std::max(y0 + i * stepY, 0.f), h - 1.f);
+      track.points.push_back(cv::Point2f(x, y));
+    }
+  }
+}
+
+void BoxTracker::update(RosBox_* boxes, int count, const cv::Mat& gray) {
+  // The interval grows by one frame for every interval tracked without losing the boxes.
+  if (lost_) {
+    interval_ = std::max(minInterval_, interval_ / 2);
+  } else if (framesSinceKeyframe_ + 1 >= interval_) {
+    interval_ = std::min(maxInterval_, interval_ + 1);
+  }
+  framesSinceKeyframe_ = 0;
+  lost_ = false;
+
+  std::vector<Track> tracks;
+  tracks.reserve(count);
+  std::vector<bool> continued(tracks_.size(), false);
+  for (int i = 0; i < count; ++i) {
+    int best = -1;
+    float bestIou = kMinTrackIou;
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+      if (continued[t] || tracks_[t].box.Class != boxes[i].Class) continue;
+      const float overlap = boxIou(boxes[i], tracks_[t].box);
+      if (overlap >= bestIou) {
+        best = t;
+        bestIou = overlap;
+      }
+    }
+    if (best >= 0) {
+      continued[best] = true;
+      boxes[i].id = tracks_[best].box.id;
+    } else {
+      boxes[i].id = nextId_;
+      nextId_ = (nextId_ + 1) % (kMaxTrackId + 1);
+    }
+    Track track;
+    track.box = boxes[i];
+    seedPoints(track, gray.cols, gray.rows);
+    tracks.push_back(track);
+  }
+  tracks_.swap(tracks);
+  // Copied, the caller reuses the image for later frames.
+  gray.copyTo(previous_);
+}
+
+double BoxTracker::propagate(const cv::Mat& gray) {
+  ++framesSinceKeyframe_;
+  if (tracks_.empty() || previous_.size() != gray.size()) {
+    tracks_.clear();
+    gray.copyTo(previous_);
+    return 1;
+  }
+
+  from_.clear();
+  for (const Track& track : tracks_) from_.insert(from_.end(), track.points.begin(), track.points.end());
+  // Points are only kept if they flow back to where they started.
+  const cv::Size window(15, 15);
+  cv::calcOpticalFlowPyrLK(previous_, gray, from_, to_, status_, error_, window, 2);
+  cv::calcOpticalFlowPyrLK(gray, previous_, to_, back_, backStatus_, error_, window, 2);
+
+  size_t first = 0;
+  size_t followed = 0;
+  std::vector<Track> tracks;
+  tracks.reserve(tracks_.size());
+  for (Track& track : tracks_) {
+    dx_.clear();
+    dy_.clear();
+    size_t valid = first;
+    for (size_t p = first; p < first + track.points.size(); ++p) {
+      const cv::Point2f error = back_[p] - from_[p];
+      if (!status_[p] || !backStatus_[p] || error.dot(error) > kMaxForwardBackwardError * kMaxForwardBackwardError) continue;
+      dx_.push_back(to_[p].x - from_[p].x);
+      dy_.push_back(to_[p].y - from_[p].y);
+      // Valid points are moved to the front of the range for the scale.
+      from_[valid] = from_[p];
+      to_[valid] = to_[p];
+      ++valid;
+    }
+    const size_t count = dx_.size();
+    followed += count;
+    const size_t end = first + track.points.size();
+    if (count < 3 || count < minConfidence_ * track.points.size()) {
+      first = end;
+      continue;
+    }
+
+    // The scale is the median change of the distances between the points.
+    scales_.clear();
+    for (size_t i = first; i < first + count; ++i) {
+      for (size_t j = i + 1; j < first + count; ++j) {
+        const cv::Point2f before = from_[i] - from_[j];
+        const cv::Point2f after = to_[i] - to_[j];
+        const float distance = std::sqrt(before.dot(before));
+        if (distance > 1) scales_.push_back(std::sqrt(after.dot(after)) / distance);
+      }
+    }
+    const float scale = scales_.empty() ? 1.f : median(scales_);
+    track.box.x += median(dx_) / gray.cols;
+    track.box.y += median(dy_) / gray.rows;
+    track.box.w *= scale;
+    track.box.h *= scale;
+    first = end;
+    if (track.box.x < 0 || track.box.x > 1 || track.box.y < 0 || track.box.y > 1) continue;
+    seedPoints(track, gray.cols, gray.rows);
+    tracks.push_back(track);
+  }
+  tracks_.swap(tracks);
+  gray.copyTo(previous_);
+
+  const double confidence = static_cast<double>(followed) / from_.size();
+  if (confidence < minConfidence_) lost_ = true;
+  return confidence;
+}
+
+int BoxTracker::boxes(RosBox_* boxes) const {
+  int count = 0;
+  for (const Track& track : tracks_) {
+    // Clipped to the image like extractBoxes.
+    const float xmin = std::max(track.box.x - track.box.w / 2, 0.f);
+    const float xmax = std::min(track.box.x + track.box.w / 2, 1.f);
+    const float ymin = std::max(track.box.y - track.box.h / 2, 0.f);
+    const float ymax = std::min(track.box.y + track.box.h / 2, 1.f);
+    boxes[count] = track.box;
+    boxes[count].x = (xmin + xmax) / 2;
+    boxes[count].y = (ymin + ymax) / 2;
+    boxes[count].w = xmax - xmin;
+    boxes[count].h = ymax - ymin;
+    ++count;
+  }
+  boxes[0].num = count;
+  return count;
+}
+
+} /* namespace darknet_ros*/
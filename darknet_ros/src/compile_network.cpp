@@ -0,0 +1,43 @@
+/*
+ * compile_network.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ *
+ *  Converts a cfg and weights file into a network blob that the node maps
+ *  at startup instead of parsing the cfg and reading the weights.
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "darknet_ros/batchnorm_folding.hpp"
+#include "darknet_ros/network_blob.hpp"
+
+int main(int argc, char** argv) {
+  if (argc != 4) {
+    fprintf(stderr, "Usage: %s <cfg file> <weights file> <blob file>\n", argv[0]);
+    return 1;
+  }
+
+  network* net = load_network(argv[1], argv[2], 0);
+  // Folded in the blob, so the node does not write to the mapped weights.
+  darknet_ros::foldBatchNorm(net);
+  std::string error;
+  const bool written = darknet_ros::writeNetworkBlob(net, argv[1], argv[3], error);
+  darknet_ros::freeNetwork(net);
+  if (!written) {
+    fprintf(stderr, "Could not write %s: %s.\n", argv[3], error.c_str());
+    return 1;
+  }
+
+  // Read the blob back once, so a blob that the node would reject is caught here.
+  net = darknet_ros::loadNetworkBlob(argv[3], 1, error);
+  if (!net) {
+    fprintf(stderr, "Could not load %s: %s.\n", argv[3], error.c_str());
+    return 1;
+  }
+  darknet_ros::freeNetwork(net);
+  printf("Wrote %s.\n", argv[3]);
+  return 0;
+}
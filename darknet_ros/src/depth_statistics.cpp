@@ -0,0 +1,245 @@
+/*
+ * depth_statistics.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/depth_statistics.hpp"
+
+// c++
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace darknet_ros {
+
+namespace {
+
+// Pixels counted per window at most, larger windows skip rows. The median of
+// a couple thousand depths is well within the noise of the sensor.
+const int kMaxSamples = 2048;
+
+// Interleaved copies of the histograms, so that runs of equal depths do not
+// wait on the increment of the same counter.
+const int kCopies = 4;
+
+// Rows of a window, every step-th of them counted.
+struct Window {
+  const cv::Mat* depth;
+  cv::Rect rect;
+  int step;
+};
+
+// Counts of the depths by their high byte, and their sums for the trimmed
+// mean. Zeros are counted in bin 0 and separately.
+struct CoarseHistogram {
+  uint32_t counts[kCopies][256];
+  uint64_t sums[kCopies][256];
+  uint32_t zeros;
+};
+
+// Counts of the low bytes of the depths whose high byte is bin, the others
+// are counted in entry 256.
+struct FineHistogram {
+  int bin;
+  uint32_t counts[kCopies][257];
+};
+
+inline int popcount(unsigned int bits) { return __builtin_popcount(bits); }
+
+template <bool Sums>
+void countCoarse(const Window& window, CoarseHistogram& histogram) {
+  memset(histogram.counts, 0, sizeof(histogram.counts));
+  if (Sums) memset(histogram.sums, 0, sizeof(histogram.sums));
+  uint32_t zeros = 0;
+  for (int y = window.rect.y; y < window.rect.br().y; y += window.step) {
+    const uint16_t* row = window.depth->ptr<uint16_t>(y) + window.rect.x;
+    int x = 0;
+#ifdef __SSE2__
+    alignas(16) uint16_t bins[8];
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 8 <= window.rect.width; x += 8) {
+      const __m128i depths = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+      zeros += popcount(_mm_movemask_epi8(_mm_cmpeq_epi16(depths, zero))) / 2;
+      _mm_store_si128(reinterpret_cast<__m128i*>(bins), _mm_srli_epi16(depths, 8));
+      for (int k = 0; k < 8; ++k) {
+        ++histogram.counts[k % kCopies][bins[k]];
+        if (Sums) histogram.sums[k % kCopies][bins[k]] += row[x + k];
+      }
+    }
+#endif
+    for (; x < window.rect.width; ++x) {
+      zeros += row[x] == 0;
+      ++histogram.counts[x % kCopies][row[x] >> 8];
+      if (Sums) histogram.sums[x % kCopies][row[x] >> 8] += row[x];
+    }
+  }
+  for (int c = 1; c < kCopies; ++c) {
+    for (int b = 0; b < 256; ++b) {
+      histogram.counts[0][b] += histogram.counts[c][b];
+      if (Sums) histogram.sums[0][b] += histogram.sums[c][b];
+    }
+  }
+  histogram.counts[0][0] -= zeros;
+  histogram.zeros = zeros;
+}
+
+void countFine(const Window& window, int bin, uint32_t zeros, FineHistogram& histogram) {
+  memset(&histogram, 0, sizeof(histogram));
+  histogram.bin = bin;
+  for (int y = window.rect.y; y < window.rect.br().y; y += window.step) {
+    const uint16_t* row = window.depth->ptr<uint16_t>(y) + window.rect.x;
+    int x = 0;
+#ifdef __SSE2__
+    alignas(16) uint16_t entries[8];
+    const __m128i high = _mm_set1_epi16(bin);
+    const __m128i other = _mm_set1_epi16(256);
+    const __m128i lowMask = _mm_set1_epi16(0xff);
+    for (; x + 8 <= window.rect.width; x += 8) {
+      const __m128i depths = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+      const __m128i inBin = _mm_cmpeq_epi16(_mm_srli_epi16(depths, 8), high);
+      const __m128i entry = _mm_or_si128(_mm_and_si128(inBin, _mm_and_si128(depths, lowMask)), _mm_andnot_si128(inBin, other));
+      _mm_store_si128(reinterpret_cast<__m128i*>(entries), entry);
+      for (int k = 0; k < 8; ++k) ++histogram.counts[k % kCopies][entries[k]];
+    }
+#endif
+    for (; x < window.rect.width; ++x) {
+      ++histogram.counts[x % kCopies][(row[x] >> 8) == bin ? (row[x] & 0xff) : 256];
+    }
+  }
+  for (int c = 1; c < kCopies; ++c) {
+    for (int j = 0; j < 256; ++j) histogram.counts[0][j] += histogram.counts[c][j];
+  }
+  if (bin == 0) histogram.counts[0][0] -= zeros;
+}
+
+// Rank queries over the valid depths of a window.
+class RankedDepths {
+ public:
+  // Sums are needed for sumBelow only.
+  RankedDepths(const Window& window, bool sums) : window_(window) {
+    if (sums) {
+      countCoarse<true>(window_, coarse_);
+    } else {
+      countCoarse<false>(window_, coarse_);
+    }
+    fine_.bin = -1;
+    valid_ = 0;
+    for (int b = 0; b < 256; ++b) valid_ += coarse_.counts[0][b];
+  }
+
+  uint32_t size() const { return valid_; }
+
+  // Depth of rank k, the smallest being rank 0.
+  int at(uint32_t k) {
+    uint32_t below = 0;
+    int b = 0;
+    while (below + coarse_.counts[0][b] <= k) below += coarse_.counts[0][b++];
+    const uint32_t* fine = fineCounts(b);
+    int j = 0;
+    while (below + fine[j] <= k) below += fine[j++];
+    return (b << 8) | j;
+  }
+
+  // Sum of the k smallest depths.
+  uint64_t sumBelow(uint32_t k) {
+    uint64_t sum = 0;
+    uint32_t below = 0;
+    int b = 0;
+    while (b < 256 && below + coarse_.counts[0][b] <= k) {
+      below += coarse_.counts[0][b];
+      sum += coarse_.sums[0][b++];
+    }
+    if (below == k) return sum;
+    const uint32_t* fine = fineCounts(b);
+    for (int j = 0; below < k; ++j) {
+      const uint32_t taken = std::min(fine[j], k - below);
+      sum += static_cast<uint64_t>(taken) * ((b << 8) | j);
+      below += taken;
+    }
+    return sum;
+  }
+
+ private:
+  const uint32_t* fineCounts(int bin) {
+    if (fine_.bin != bin) countFine(window_, bin, coarse_.zeros, fine_);
+    return fine_.counts[0];
+  }
+
+  const Window& window_;
+  CoarseHistogram coarse_;
+  FineHistogram fine_;
+  uint32_t valid_;
+};
+
+}  // namespace
+
+bool parseDepthStatistic(const std::string& name, DepthStatistic_& statistic) {
+  if (name == "center") {
+    statistic = DEPTH_CENTER;
+  } else if (name == "median") {
+    statistic = DEPTH_MEDIAN;
+  } else if (name == "trimmed_mean") {
+    statistic = DEPTH_TRIMMED_MEAN;
+  } else if (name == "percentile") {
+    statistic = DEPTH_PERCENTILE;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+DepthEstimator::DepthEstimator(DepthStatistic_ statistic, double window, double trim, double percentile, int threads)
+    : statistic_(statistic),
+      window_(std::min(std::max(window, 0.), 1.)),
+      trim_(std::min(std::max(trim, 0.), .5)),
+      percentile_(std::min(std::max(percentile, 0.), 1.)),
+      pool_(std::max(threads, 1)) {}
+
+float DepthEstimator::estimate(const cv::Mat& depth, const cv::Rect& box) const {
+  if (depth.empty() || depth.type() != CV_16UC1) return 0;
+  const int u = box.x + box.width / 2;
+  const int v = box.y + box.height / 2;
+  if (statistic_ == DEPTH_CENTER) {
+    return u >= 0 && v >= 0 && u < depth.cols && v < depth.rows ? depth.at<uint16_t>(v, u) : 0;
+  }
+
+  const int width = std::max(1, static_cast<int>(std::lround(box.width * window_)));
+  const int height = std::max(1, static_cast<int>(std::lround(box.height * window_)));
+  Window window;
+  window.depth = &depth;
+  window.rect = cv::Rect(u - width / 2, v - height / 2, width, height) & cv::Rect(0, 0, depth.cols, depth.rows);
+  if (window.rect.width <= 0 || window.rect.height <= 0) return 0;
+  const int rows = std::max(1, kMaxSamples / window.rect.width);
+  window.step = (window.rect.height + rows - 1) / rows;
+
+  RankedDepths depths(window, statistic_ == DEPTH_TRIMMED_MEAN);
+  const uint32_t count = depths.size();
+  if (count == 0) return 0;
+  switch (statistic_) {
+    case DEPTH_TRIMMED_MEAN: {
+      const uint32_t low = static_cast<uint32_t>(trim_ * count);
+      const uint32_t high = count - low;
+      if (high > low) return static_cast<float>(depths.sumBelow(high) - depths.sumBelow(low)) / (high - low);
+      return depths.at((count - 1) / 2);
+    }
+    case DEPTH_PERCENTILE:
+      return depths.at(static_cast<uint32_t>(percentile_ * (count - 1)));
+    default:
+      return depths.at((count - 1) / 2);
+  }
+}
+
+void DepthEstimator::estimate(const cv::Mat& depth, const cv::Rect* boxes, int count, float* depths) {
+  pool_.parallelFor(count, [&](int begin, int end) {
+    for (int i = begin; i < end; ++i) depths[i] = estimate(depth, boxes[i]);
+  });
+}
+
+} /* namespace darknet_ros*/
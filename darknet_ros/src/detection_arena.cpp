@@ -0,0 +1,52 @@
+/*
+ * detection_arena.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/detection_arena.hpp"
+
+// c++
+#include <algorithm>
+
+namespace darknet_ros {
+
+namespace {
+
+bool isDetectionLayer(const layer& l) {
+  return l.type == YOLO || l.type == REGION || l.type == DETECTION;
+}
+
+}  // namespace
+
+int maxDetections(const network* net) {
+  int total = 0;
+  for (int i = 0; i < net->n; ++i) {
+    const layer& l = net->layers[i];
+    if (isDetectionLayer(l)) total += l.w * l.h * l.n;
+  }
+  return total;
+}
+
+void DetectionArena::resize(const network* net, int images) {
+  // Sized for the widest layer, like make_network_boxes does for the last.
+  int classes = 0;
+  int masks = 0;
+  for (int i = 0; i < net->n; ++i) {
+    const layer& l = net->layers[i];
+    if (!isDetectionLayer(l)) continue;
+    classes = std::max(classes, l.classes);
+    masks = std::max(masks, l.coords - 4);
+  }
+  const int count = maxDetections(net) * images;
+  dets_.assign(count, detection());
+  probs_.assign(count * classes, 0.f);
+  masks_.assign(count * masks, 0.f);
+  for (int i = 0; i < count; ++i) {
+    dets_[i].prob = probs_.data() + i * classes;
+    dets_[i].mask = masks > 0 ? masks_.data() + i * masks : 0;
+  }
+}
+
+} /* namespace darknet_ros*/
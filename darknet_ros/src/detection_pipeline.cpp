@@ -0,0 +1,261 @@
+/*
+ * detection_pipeline.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/detection_pipeline.hpp"
+
+// c++
+#include <dirent.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+extern "C" {
+#include "detection_layer.h"
+#include "region_layer.h"
+#include "utils.h"
+#include "yolo_layer.h"
+}
+
+namespace darknet_ros {
+
+network* parseNetworkWithBatch(const std::string& cfgText, int batch) {
+  std::istringstream in(cfgText);
+  std::stringstream cfg;
+  std::string line;
+  bool inNet = false;
+  while (std::getline(in, line)) {
+    const size_t first = line.find_first_not_of(" \t");
+    if (first != std::string::npos && line[first] == '[') {
+      inNet = line.compare(first, 5, "[net]") == 0 || line.compare(first, 9, "[network]") == 0;
+      cfg << line << '\n';
+      if (inNet) cfg << "batch=" << batch << "\nsubdivisions=1\n";
+      continue;
+    }
+    if (inNet) {
+      std::string key = line.substr(0, line.find('='));
+      key.erase(std::remove_if(key.begin(), key.end(), ::isspace), key.end());
+      if (key == "batch" || key == "subdivisions") continue;
+    }
+    cfg << line << '\n';
+  }
+
+  // Like load_network, a cfg that cannot be written is fatal.
+  char batchCfgFile[] = "/tmp/darknet_ros_batch_XXXXXX";
+  const int fd = mkstemp(batchCfgFile);
+  if (fd < 0) file_error(batchCfgFile);
+  const std::string text = cfg.str();
+  const bool written = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+  close(fd);
+  if (!written) {
+    unlink(batchCfgFile);
+    file_error(batchCfgFile);
+  }
+  network* net = parse_network_cfg(batchCfgFile);
+  unlink(batchCfgFile);
+  set_batch_network(net, batch);
+  return net;
+}
+
+network* loadNetworkWithBatch(char* cfgfile, char* weightfile, int batch) {
+  if (batch <= 1) {
+    network* net = load_network(cfgfile, weightfile, 0);
+    set_batch_network(net, 1);
+    return net;
+  }
+
+  // Like load_network, a cfg that cannot be read is fatal.
+  std::ifstream in(cfgfile);
+  std::stringstream cfg;
+  cfg << in.rdbuf();
+  if (!in) file_error(cfgfile);
+  network* net = parseNetworkWithBatch(cfg.str(), batch);
+  if (weightfile && weightfile[0] != 0) {
+    load_weights(net, weightfile);
+  }
+  set_batch_network(net, batch);
+  return net;
+}
+
+int getBatchBoxes(network* net, int b, int w, int h, float thresh, float hier, detection* dets) {
+  // The detection layers decode the first image of the batch, so they are
+  // pointed at image b for the call. Their batch is set to one as region
+  // layers read a batch of two as an image and its mirror image.
+  int i;
+  for (i = 0; i < net->n; ++i) {
+    layer* l = &net->layers[i];
+    if (l->type == YOLO || l->type == REGION || l->type == DETECTION) {
+      l->output += b * l->outputs;
+      l->batch = 1;
+    }
+  }
+  // fill_network_boxes into the given detections.
+  int count = 0;
+  for (i = 0; i < net->n; ++i) {
+    layer* l = &net->layers[i];
+    if (l->type == YOLO) {
+      count += get_yolo_detections(*l, w, h, net->w, net->h, thresh, 0, 1, dets + count);
+    }
+    if (l->type == REGION) {
+      get_region_detections(*l, w, h, net->w, net->h, thresh, 0, hier, 1, dets + count);
+      count += l->w * l->h * l->n;
+    }
+    if (l->type == DETECTION) {
+      get_detection_detections(*l, w, h, thresh, dets + count);
+      count += l->w * l->h * l->n;
+    }
+  }
+  for (i = 0; i < net->n; ++i) {
+    layer* l = &net->layers[i];
+    if (l->type == YOLO || l->type == REGION || l->type == DETECTION) {
+      l->output -= b * l->outputs;
+      l->batch = net->batch;
+    }
+  }
+  return count;
+}
+
+int tilesToCover(int length, int tileSize, double overlap) {
+  if (tileSize >= length) return 1;
+  const double step = tileSize * (1 - overlap);
+  return std::max(1, static_cast<int>(std::ceil((length - tileSize) / step - 1e-9)) + 1);
+}
+
+std::vector<cv::Rect> tileFrame(int width, int height, int columns, int rows, double overlap) {
+  // n tiles of size t overlapping by overlap * t cover t * (n - (n - 1) * overlap).
+  const int tileWidth = std::min(width, static_cast<int>(std::ceil(width / (columns - (columns - 1) * overlap))));
+  const int tileHeight = std::min(height, static_cast<int>(std::ceil(height / (rows - (rows - 1) * overlap))));
+  std::vector<cv::Rect> tiles;
+  tiles.reserve(columns * rows);
+  for (int r = 0; r < rows; ++r) {
+    const int y = rows > 1 ? static_cast<int>(std::lround(r * (height - tileHeight) / static_cast<double>(rows - 1))) : 0;
+    for (int c = 0; c < columns; ++c) {
+      const int x = columns > 1 ? static_cast<int>(std::lround(c * (width - tileWidth) / static_cast<double>(columns - 1))) : 0;
+      tiles.push_back(cv::Rect(x, y, tileWidth, tileHeight));
+    }
+  }
+  return tiles;
+}
+
+int getTiledBoxes(network* net, int b, int w, int h, const std::vector<cv::Rect>& tiles, float thresh, float hier, detection* dets) {
+  int count = 0;
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    const cv::Rect& tile = tiles[i];
+    const int tileCount = getBatchBoxes(net, b + i, tile.width, tile.height, thresh, hier, dets + count);
+    for (int j = count; j < count + tileCount; ++j) {
+      box& bbox = dets[j].bbox;
+      bbox.x = (tile.x + bbox.x * tile.width) / w;
+      bbox.y = (tile.y + bbox.y * tile.height) / h;
+      bbox.w *= static_cast<float>(tile.width) / w;
+      bbox.h *= static_cast<float>(tile.height) / h;
+    }
+    count += tileCount;
+  }
+  return count;
+}
+
+int extractBoxes(const detection* dets, int nboxes, int classes, RosBox_* boxes) {
+  int i, j;
+  int count = 0;
+  for (i = 0; i < nboxes; ++i) {
+    float xmin = dets[i].bbox.x - dets[i].bbox.w / 2.;
+    float xmax = dets[i].bbox.x + dets[i].bbox.w / 2.;
+    float ymin = dets[i].bbox.y - dets[i].bbox.h / 2.;
+    float ymax = dets[i].bbox.y + dets[i].bbox.h / 2.;
+
+    if (xmin < 0) xmin = 0;
+    if (ymin < 0) ymin = 0;
+    if (xmax > 1) xmax = 1;
+    if (ymax > 1) ymax = 1;
+
+    // iterate through possible boxes and collect the bounding boxes
+    for (j = 0; j < classes; ++j) {
+      if (dets[i].prob[j]) {
+        float x_center = (xmin + xmax) / 2;
+        float y_center = (ymin + ymax) / 2;
+        float BoundingBox_width = xmax - xmin;
+        float BoundingBox_height = ymax - ymin;
+
+        // define bounding box
+        // BoundingBox must be 1% size of frame (3.2x2.4 pixels)
+        if (BoundingBox_width > 0.01 && BoundingBox_height > 0.01) {
+          boxes[count].x = x_center;
+          boxes[count].y = y_center;
+          boxes[count].w = BoundingBox_width;
+          boxes[count].h = BoundingBox_height;
+          boxes[count].Class = j;
+          boxes[count].prob = dets[i].prob[j];
+          count++;
+        }
+      }
+    }
+  }
+
+  // if no object detected, make sure that ROS knows that num = 0
+  boxes[0].num = count;
+  return count;
+}
+
+float boxIou(const RosBox_& a, const RosBox_& b) {
+  const float w = std::min(a.x + a.w / 2, b.x + b.w / 2) - std::max(a.x - a.w / 2, b.x - b.w / 2);
+  const float h = std::min(a.y + a.h / 2, b.y + b.h / 2) - std::max(a.y - a.h / 2, b.y - b.h / 2);
+  if (w <= 0 || h <= 0) return 0;
+  const float intersection = w * h;
+  return intersection / (a.w * a.h + b.w * b.h - intersection);
+}
+
+std::vector<std::string> listImages(const std::string& dir) {
+  static const char* const extensions[] = {".png", ".jpg", ".jpeg", ".bmp"};
+  std::vector<std::string> images;
+  DIR* handle = opendir(dir.c_str());
+  if (!handle) return images;
+  while (dirent* entry = readdir(handle)) {
+    std::string name = entry->d_name;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    for (const char* extension : extensions) {
+      const size_t length = strlen(extension);
+      if (name.size() > length && name.compare(name.size() - length, length, extension) == 0) {
+        images.push_back(dir + "/" + entry->d_name);
+        break;
+      }
+    }
+  }
+  closedir(handle);
+  std::sort(images.begin(), images.end());
+  return images;
+}
+
+cv::Point3f backProject(const cv::Mat& depth, const DepthIntrinsics_& intrinsics, int u, int v) {
+  /*
+  Depth image ROS REP : https://www.ros.org/reps/rep-0118.html
+
+  Formula for calculating X,Y in camera frame (Z in front (Depth), X is up, y is right (toward USB-C))
+  Xreal = (u - cx) * Z / fx;
+  Yreal = (v - cy) * Z / fy; 
+  Zreal = Z
+
+  u, v   = Desired pixel values
+  cx, cy = Intrinsic camera parameter (Principal points)
+  fx, fy = Intrinsic camera parameter (Focal lengths)
+  Z      = Depth of (u, v) from camera
+
+  */
+  const bool inside = u >= 0 && v >= 0 && u < depth.cols && v < depth.rows;
+  const float Z = depth.empty() || !inside ? 0 : 0.001 * depth.at<uint16_t>(v, u);  //FOR 16UC1 (values in mm)
+  return backProject(intrinsics, u, v, Z);
+}
+
+cv::Point3f backProject(const DepthIntrinsics_& intrinsics, int u, int v, float Z) {
+  return cv::Point3f((u - intrinsics.cx) * Z / intrinsics.fx, (v - intrinsics.cy) * Z / intrinsics.fy, Z);
+}
+
+} /* namespace darknet_ros*/
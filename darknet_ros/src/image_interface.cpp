@@ -8,43 +8,487 @@
 
 #include "darknet_ros/image_interface.hpp"
 
+#include <algorithm>
+#include <mutex>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DARKNET_ROS_X86 1
+#endif
+
+#ifdef DARKNET_ROS_X86
+// AVX2 kernels are compiled for the target attribute and picked at runtime,
+// so the package still runs on CPUs without AVX2.
+static int cpu_has_avx2() {
+  static const int has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+}
+#endif
+
 static float get_pixel(image m, int x, int y, int c) {
   assert(x < m.w && y < m.h && c < m.c);
   return m.data[c * m.h * m.w + y * m.w + x];
 }
 
-image** load_alphabet_with_file(char* datafile) {
-  int i, j;
-  const int nsize = 8;
-  image** alphabets = (image**)calloc(nsize, sizeof(image));
-  char* labels = "/labels/%d_%d.png";
-  char* files = (char*)malloc(1 + strlen(datafile) + strlen(labels));
-  strcpy(files, datafile);
-  strcat(files, labels);
-  for (j = 0; j < nsize; ++j) {
-    alphabets[j] = (image*)calloc(128, sizeof(image));
-    for (i = 32; i < 127; ++i) {
-      char buff[256];
-      sprintf(buff, files, i, j);
-      alphabets[j][i] = load_image_color(buff, 0, 0);
+#ifdef OPENCV
+/*
+ * Coverage of the printable ASCII characters of one label size, side by side
+ * in a single 8 bit image.
+ */
+typedef struct {
+  cv::Mat coverage;
+  int left[GLYPH_COUNT];
+  int width[GLYPH_COUNT];
+} glyph_atlas;
+
+static glyph_atlas atlases[LABEL_SIZES];
+static std::once_flag atlas_rendered[LABEL_SIZES];
+
+// Same font scale steps as darknet's data/labels/<char>_<size>.png.
+static void render_glyph_atlas(int size, glyph_atlas* atlas) {
+  const int font = cv::FONT_HERSHEY_SIMPLEX;
+  const double scale = .35 + .25 * size;
+  const int thickness = 1 + size / 2;
+  int ascent = 0;
+  int descent = 0;
+  int total = 0;
+  for (int i = 0; i < GLYPH_COUNT; ++i) {
+    int baseline = 0;
+    const cv::Size text = cv::getTextSize(std::string(1, (char)(FIRST_GLYPH + i)), font, scale, thickness, &baseline);
+    ascent = std::max(ascent, text.height);
+    descent = std::max(descent, baseline);
+    atlas->left[i] = total;
+    atlas->width[i] = text.width;
+    total += text.width;
+  }
+  atlas->coverage = cv::Mat(ascent + descent, total, CV_8UC1, cv::Scalar(0));
+  for (int i = 0; i < GLYPH_COUNT; ++i) {
+    cv::putText(atlas->coverage, std::string(1, (char)(FIRST_GLYPH + i)), cv::Point(atlas->left[i], ascent), font, scale,
+                cv::Scalar(255), thickness, cv::LINE_AA);
+  }
+}
+
+static const glyph_atlas* get_glyph_atlas(int size) {
+  size = std::max(0, std::min(size, LABEL_SIZES - 1));
+  std::call_once(atlas_rendered[size], render_glyph_atlas, size, &atlases[size]);
+  return &atlases[size];
+}
+
+size_t load_glyph_atlas(int size) {
+  const glyph_atlas* atlas = get_glyph_atlas(size);
+  return atlas->coverage.total() + sizeof(glyph_atlas);
+}
+
+void draw_label_text(image im, int row, int col, const char* text, const float* rgb, int size) {
+  const glyph_atlas* atlas = get_glyph_atlas(size);
+  const cv::Mat& coverage = atlas->coverage;
+  // Black text on a box of the class color, with a border of a quarter of the text height like darknet's get_label.
+  const int border = coverage.rows * .25;
+  int w = 2 * border;
+  for (const char* t = text; *t; ++t) {
+    const int g = *t - FIRST_GLYPH;
+    if (g >= 0 && g < GLYPH_COUNT) w += atlas->width[g];
+  }
+  const int h = coverage.rows + 2 * border;
+  if (row - h >= 0) row -= h;
+  const int rows = std::min(h, im.h - row);
+  const int cols = std::min(w, im.w - col);
+  if (row < 0 || col < 0 || rows <= 0 || cols <= 0) return;
+
+  for (int k = 0; k < im.c && k < 3; ++k) {
+    for (int j = 0; j < rows; ++j) {
+      float* out = im.data + k * im.h * im.w + (row + j) * im.w + col;
+      std::fill(out, out + cols, rgb[k]);
     }
   }
-  return alphabets;
+  int x = border;
+  for (const char* t = text; *t && x < cols; ++t) {
+    const int g = *t - FIRST_GLYPH;
+    if (g < 0 || g >= GLYPH_COUNT) continue;
+    for (int j = 0; j < coverage.rows && border + j < rows; ++j) {
+      const unsigned char* glyph = coverage.ptr<unsigned char>(j) + atlas->left[g];
+      const int y = row + border + j;
+      for (int i = 0; i < atlas->width[g] && x + i < cols; ++i) {
+        if (!glyph[i]) continue;
+        const float background = 1 - glyph[i] / 255.f;
+        for (int k = 0; k < im.c && k < 3; ++k) {
+          im.data[k * im.h * im.w + y * im.w + col + x + i] = rgb[k] * background;
+        }
+      }
+    }
+    x += atlas->width[g];
+  }
 }
 
+void draw_detection_labels(image im, detection* dets, int num, float thresh, char** names, int classes) {
+  for (int i = 0; i < num; ++i) {
+    // Label text, class color and box position as in darknet's draw_detections.
+    std::string label;
+    int cls = -1;
+    for (int j = 0; j < classes; ++j) {
+      if (dets[i].prob[j] > thresh) {
+        if (cls >= 0) label += ", ";
+        label += names[j];
+        if (cls < 0) cls = j;
+      }
+    }
+    if (cls < 0) continue;
+    const int width = im.h * .006;
+    const int offset = cls * 123457 % classes;
+    const float rgb[3] = {get_color(2, offset, classes), get_color(1, offset, classes), get_color(0, offset, classes)};
+    const box b = dets[i].bbox;
+    int left = (b.x - b.w / 2.) * im.w;
+    int top = (b.y - b.h / 2.) * im.h;
+    if (left < 0) left = 0;
+    if (top < 0) top = 0;
+    draw_label_text(im, top + width, left, label.c_str(), rgb, (int)(im.h * .03) / 10);
+  }
+}
+#endif
+
 #ifdef OPENCV
-void generate_image(image p, cv::Mat& disp) {
-  int x, y, k;
-  if (p.c == 3) rgbgr_image(p);
-  // normalize_image(copy);
-
-  int step = disp.step;
-  for (y = 0; y < p.h; ++y) {
-    for (x = 0; x < p.w; ++x) {
-      for (k = 0; k < p.c; ++k) {
-        disp.data[y * step + x * p.c + k] = (unsigned char)(get_pixel(p, x, y, k) * 255);
+static inline unsigned char saturate_pixel(float v) {
+  v *= 255;
+  if (!(v > 0)) return 0;
+  if (v > 255) return 255;
+  return (unsigned char)v;
+}
+
+#ifdef DARKNET_ROS_X86
+// Scales 16 floats by 255 and converts them to bytes, truncating like the
+// scalar cast and saturating to [0, 255].
+static inline __m128i saturate_pixels_sse2(const float* src) {
+  const __m128 scale = _mm_set1_ps(255.f);
+  const __m128 zero = _mm_setzero_ps();
+  __m128i v[4];
+  for (int i = 0; i < 4; ++i) {
+    __m128 f = _mm_mul_ps(_mm_loadu_ps(src + 4 * i), scale);
+    v[i] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(f, zero), scale));
+  }
+  return _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+}
+
+// Interleaves 16 pixels of three planes into 48 bytes with byte shuffles.
+__attribute__((target("avx2"))) static int generate_row_avx2(const float* const planes[3], int w, unsigned char* out) {
+  static const struct Masks {
+    unsigned char m[3][3][16];
+    Masks() {
+      for (int j = 0; j < 3; ++j)
+        for (int k = 0; k < 3; ++k)
+          for (int i = 0; i < 16; ++i) m[j][k][i] = ((16 * j + i) % 3 == k) ? (16 * j + i) / 3 : 0x80;
+    }
+  } masks;
+  int x = 0;
+  for (; x + 16 <= w; x += 16) {
+    const __m128i c0 = saturate_pixels_sse2(planes[0] + x);
+    const __m128i c1 = saturate_pixels_sse2(planes[1] + x);
+    const __m128i c2 = saturate_pixels_sse2(planes[2] + x);
+    for (int j = 0; j < 3; ++j) {
+      __m128i v = _mm_shuffle_epi8(c0, _mm_loadu_si128((const __m128i*)masks.m[j][0]));
+      v = _mm_or_si128(v, _mm_shuffle_epi8(c1, _mm_loadu_si128((const __m128i*)masks.m[j][1])));
+      v = _mm_or_si128(v, _mm_shuffle_epi8(c2, _mm_loadu_si128((const __m128i*)masks.m[j][2])));
+      _mm_storeu_si128((__m128i*)(out + 3 * x + 16 * j), v);
+    }
+  }
+  return x;
+}
+#endif
+
+// Converts one row of planar floats into interleaved bytes.
+static void generate_row(const float* const* planes, int c, int w, unsigned char* out) {
+  int x = 0;
+#ifdef DARKNET_ROS_X86
+  if (c == 3 && cpu_has_avx2()) {
+    x = generate_row_avx2(planes, w, out);
+  } else {
+    unsigned char converted[16];
+    for (; x + 16 <= w; x += 16) {
+      for (int k = 0; k < c; ++k) {
+        _mm_storeu_si128((__m128i*)converted, saturate_pixels_sse2(planes[k] + x));
+        for (int i = 0; i < 16; ++i) out[(x + i) * c + k] = converted[i];
       }
     }
   }
+#endif
+  for (; x < w; ++x) {
+    for (int k = 0; k < c; ++k) {
+      out[x * c + k] = saturate_pixel(planes[k][x]);
+    }
+  }
+}
+
+class GenerateImageRows : public cv::ParallelLoopBody {
+ public:
+  GenerateImageRows(image p, cv::Mat& disp) : p_(p), disp_(disp) {}
+
+  void operator()(const cv::Range& rows) const {
+    const float* planes[4];
+    for (int y = rows.start; y < rows.end; ++y) {
+      for (int k = 0; k < p_.c; ++k) {
+        // Three channel images are written in reverse channel order.
+        const int plane = (p_.c == 3) ? 2 - k : k;
+        planes[k] = p_.data + plane * p_.w * p_.h + y * p_.w;
+      }
+      generate_row(planes, p_.c, p_.w, disp_.ptr<unsigned char>(y));
+    }
+  }
+
+ private:
+  image p_;
+  cv::Mat& disp_;
+};
+
+void generate_image(image p, cv::Mat& disp, int nthreads) {
+  assert(p.c <= 4 && disp.cols == p.w && disp.rows == p.h && disp.elemSize() == (size_t)p.c);
+  GenerateImageRows rows(p, disp);
+  if (nthreads > 1) {
+    cv::parallel_for_(cv::Range(0, p.h), rows, nthreads);
+  } else {
+    rows(cv::Range(0, p.h));
+  }
 }
 #endif
+
+extern "C" image mat_to_image(cv::Mat m);
+
+letterbox_plan make_letterbox_plan() {
+  letterbox_plan plan;
+  memset(&plan, 0, sizeof(plan));
+  plan.row_y[0] = plan.row_y[1] = -1;
+  return plan;
+}
+
+void free_letterbox_plan(letterbox_plan* plan) {
+  free(plan->x0);
+  free(plan->x1);
+  free(plan->fx);
+  free(plan->y0);
+  free(plan->y1);
+  free(plan->fy);
+  free(plan->rows[0]);
+  free(plan->rows[1]);
+  *plan = make_letterbox_plan();
+}
+
+int mat_to_image_swaps_rb() {
+  static const int swaps = [] {
+    cv::Mat probe(1, 1, CV_8UC3, cv::Scalar(255, 0, 0));
+    image im = mat_to_image(probe);
+    int swapped = im.data[0] < .5f;
+    free_image(im);
+    return swapped;
+  }();
+  return swaps;
+}
+
+void mat_into_image(const cv::Mat& src, int swap_rb, image im) {
+  assert(src.type() == CV_8UC3 && src.cols == im.w && src.rows == im.h && im.c == 3);
+  const float scale = 1.f / 255.f;
+  const int plane = im.w * im.h;
+  float* b = im.data + (swap_rb ? 2 : 0) * plane;
+  float* g = im.data + plane;
+  float* r = im.data + (swap_rb ? 0 : 2) * plane;
+  for (int y = 0; y < im.h; ++y) {
+    const unsigned char* row = src.ptr<unsigned char>(y);
+    const int offset = y * im.w;
+    for (int x = 0; x < im.w; ++x) {
+      b[offset + x] = row[3 * x + 0] * scale;
+      g[offset + x] = row[3 * x + 1] * scale;
+      r[offset + x] = row[3 * x + 2] * scale;
+    }
+  }
+}
+
+// Builds the tables with the same float arithmetic as darknet's resize_image,
+// so both paths sample the same source pixels with the same weights.
+static void build_letterbox_plan(letterbox_plan* plan, int src_w, int src_h, int dst_w, int dst_h) {
+  free_letterbox_plan(plan);
+  int new_w = src_w;
+  int new_h = src_h;
+  if (((float)dst_w / src_w) < ((float)dst_h / src_h)) {
+    new_w = dst_w;
+    new_h = (src_h * dst_w) / src_w;
+  } else {
+    new_h = dst_h;
+    new_w = (src_w * dst_h) / src_h;
+  }
+  plan->src_w = src_w;
+  plan->src_h = src_h;
+  plan->dst_w = dst_w;
+  plan->dst_h = dst_h;
+  plan->new_w = new_w;
+  plan->new_h = new_h;
+  plan->off_x = (dst_w - new_w) / 2;
+  plan->off_y = (dst_h - new_h) / 2;
+
+  // Padded to a multiple of 8 so the vector loops may run over the end.
+  const int padded_w = (new_w + 7) & ~7;
+  plan->x0 = (int*)calloc(padded_w, sizeof(int));
+  plan->x1 = (int*)calloc(padded_w, sizeof(int));
+  plan->fx = (float*)calloc(padded_w, sizeof(float));
+  const float w_scale = (float)(src_w - 1) / (new_w - 1);
+  for (int c = 0; c < new_w; ++c) {
+    if (c == new_w - 1 || src_w == 1) {
+      plan->x0[c] = plan->x1[c] = 3 * (src_w - 1);
+      plan->fx[c] = 0;
+    } else {
+      float sx = c * w_scale;
+      int ix = (int)sx;
+      plan->x0[c] = 3 * ix;
+      plan->x1[c] = 3 * (ix + 1);
+      plan->fx[c] = sx - ix;
+    }
+  }
+
+  plan->y0 = (int*)calloc(new_h, sizeof(int));
+  plan->y1 = (int*)calloc(new_h, sizeof(int));
+  plan->fy = (float*)calloc(new_h, sizeof(float));
+  const float h_scale = (float)(src_h - 1) / (new_h - 1);
+  for (int r = 0; r < new_h; ++r) {
+    float sy = r * h_scale;
+    int iy = (int)sy;
+    plan->y0[r] = iy;
+    plan->fy[r] = sy - iy;
+    plan->y1[r] = (r == new_h - 1 || src_h == 1) ? -1 : iy + 1;
+  }
+
+  plan->rows[0] = (float*)calloc(3 * padded_w, sizeof(float));
+  plan->rows[1] = (float*)calloc(3 * padded_w, sizeof(float));
+  plan->row_y[0] = plan->row_y[1] = -1;
+}
+
+static void resample_row_scalar(const letterbox_plan* plan, const unsigned char* row, int first, float* out[3]) {
+  const float scale = 1.f / 255.f;
+  for (int c = first; c < plan->new_w; ++c) {
+    const unsigned char* p0 = row + plan->x0[c];
+    const unsigned char* p1 = row + plan->x1[c];
+    const float dx = plan->fx[c];
+    for (int k = 0; k < 3; ++k) {
+      out[k][c] = ((1 - dx) * p0[k] + dx * p1[k]) * scale;
+    }
+  }
+}
+
+#ifdef DARKNET_ROS_X86
+// Gathers one 32 bit word per column, which holds all three channels of a
+// pixel. Stops before the last source pixel, whose word would read past the row.
+__attribute__((target("avx2"))) static int resample_row_avx2(const letterbox_plan* plan, const unsigned char* row, float* out[3]) {
+  const int last = 3 * (plan->src_w - 1);
+  const __m256i mask = _mm256_set1_epi32(0xff);
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256 scale = _mm256_set1_ps(1.f / 255.f);
+  int c = 0;
+  for (; c + 8 <= plan->new_w && plan->x1[c + 7] < last; c += 8) {
+    const __m256i i0 = _mm256_loadu_si256((const __m256i*)(plan->x0 + c));
+    const __m256i i1 = _mm256_loadu_si256((const __m256i*)(plan->x1 + c));
+    const __m256i p0 = _mm256_i32gather_epi32((const int*)row, i0, 1);
+    const __m256i p1 = _mm256_i32gather_epi32((const int*)row, i1, 1);
+    const __m256 dx = _mm256_loadu_ps(plan->fx + c);
+    const __m256 w0 = _mm256_sub_ps(one, dx);
+    for (int k = 0; k < 3; ++k) {
+      const __m256 a = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(p0, 8 * k), mask));
+      const __m256 b = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(p1, 8 * k), mask));
+      const __m256 v = _mm256_add_ps(_mm256_mul_ps(w0, a), _mm256_mul_ps(dx, b));
+      _mm256_storeu_ps(out[k] + c, _mm256_mul_ps(v, scale));
+    }
+  }
+  return c;
+}
+
+__attribute__((target("avx2"))) static void blend_rows_avx2(const float* r0, const float* r1, float w0, float w1, int n, float* out) {
+  const __m256 a = _mm256_set1_ps(w0);
+  const __m256 b = _mm256_set1_ps(w1);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 v = _mm256_mul_ps(a, _mm256_loadu_ps(r0 + i));
+    if (r1) v = _mm256_add_ps(v, _mm256_mul_ps(b, _mm256_loadu_ps(r1 + i)));
+    _mm256_storeu_ps(out + i, v);
+  }
+  for (; i < n; ++i) {
+    out[i] = w0 * r0[i] + (r1 ? w1 * r1[i] : 0.f);
+  }
+}
+#endif
+
+static void blend_rows(const float* r0, const float* r1, float w0, float w1, int n, float* out) {
+#ifdef DARKNET_ROS_X86
+  if (cpu_has_avx2()) {
+    blend_rows_avx2(r0, r1, w0, w1, n, out);
+    return;
+  }
+  const __m128 a = _mm_set1_ps(w0);
+  const __m128 b = _mm_set1_ps(w1);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 v = _mm_mul_ps(a, _mm_loadu_ps(r0 + i));
+    if (r1) v = _mm_add_ps(v, _mm_mul_ps(b, _mm_loadu_ps(r1 + i)));
+    _mm_storeu_ps(out + i, v);
+  }
+#else
+  int i = 0;
+#endif
+  for (; i < n; ++i) {
+    out[i] = w0 * r0[i] + (r1 ? w1 * r1[i] : 0.f);
+  }
+}
+
+// Returns source row y resampled to new_w columns, reusing the cached rows.
+// The cached row keep_y is never evicted.
+static const float* resampled_row(letterbox_plan* plan, const cv::Mat& src, int y, int keep_y, int swap_rb, int channel) {
+  int slot;
+  if (plan->row_y[0] == y) {
+    slot = 0;
+  } else if (plan->row_y[1] == y) {
+    slot = 1;
+  } else {
+    slot = (plan->row_y[0] == keep_y) ? 1 : 0;
+    const int padded_w = (plan->new_w + 7) & ~7;
+    float* base = plan->rows[slot];
+    float* out[3] = {base + (swap_rb ? 2 : 0) * padded_w, base + padded_w, base + (swap_rb ? 0 : 2) * padded_w};
+    const unsigned char* row = src.ptr<unsigned char>(y);
+    int first = 0;
+#ifdef DARKNET_ROS_X86
+    if (cpu_has_avx2()) first = resample_row_avx2(plan, row, out);
+#endif
+    resample_row_scalar(plan, row, first, out);
+    plan->row_y[slot] = y;
+  }
+  return plan->rows[slot] + channel * ((plan->new_w + 7) & ~7);
+}
+
+void letterbox_mat_into(const cv::Mat& src, int swap_rb, image boxed, letterbox_plan* plan) {
+  assert(src.type() == CV_8UC3 && boxed.c == 3);
+  if (plan->src_w != src.cols || plan->src_h != src.rows || plan->dst_w != boxed.w || plan->dst_h != boxed.h) {
+    build_letterbox_plan(plan, src.cols, src.rows, boxed.w, boxed.h);
+  }
+  // Rows are cached per call only, the source changes between calls.
+  plan->row_y[0] = plan->row_y[1] = -1;
+
+  const int new_w = plan->new_w;
+  const int new_h = plan->new_h;
+  for (int k = 0; k < 3; ++k) {
+    float* dst = boxed.data + k * boxed.w * boxed.h;
+    // Border rows and columns keep letterbox_image's gray.
+    for (int r = 0; r < boxed.h; ++r) {
+      float* out = dst + r * boxed.w;
+      if (r < plan->off_y || r >= plan->off_y + new_h) {
+        std::fill(out, out + boxed.w, .5f);
+      } else {
+        std::fill(out, out + plan->off_x, .5f);
+        std::fill(out + plan->off_x + new_w, out + boxed.w, .5f);
+      }
+    }
+  }
+  for (int r = 0; r < new_h; ++r) {
+    const int y0 = plan->y0[r];
+    const int y1 = plan->y1[r];
+    const float dy = plan->fy[r];
+    for (int k = 0; k < 3; ++k) {
+      const float* row0 = resampled_row(plan, src, y0, y1, swap_rb, k);
+      const float* row1 = (y1 < 0) ? 0 : resampled_row(plan, src, y1, y0, swap_rb, k);
+      float* out = boxed.data + k * boxed.w * boxed.h + (plan->off_y + r) * boxed.w + plan->off_x;
+      blend_rows(row0, row1, 1 - dy, dy, new_w, out);
+    }
+  }
+}
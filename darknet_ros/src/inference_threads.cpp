@@ -0,0 +1,49 @@
+/*
+ * inference_threads.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/inference_threads.hpp"
+
+// c++
+#include <memory>
+#include <mutex>
+
+// Worker threads.
+#include "darknet_ros/ThreadPool.hpp"
+
+namespace darknet_ros {
+
+namespace {
+
+std::unique_ptr<ThreadPool> pool;
+std::vector<int> poolCpus;
+std::mutex mutexPool;
+
+}  // namespace
+
+void setInferenceThreads(int threads, const std::vector<int>& cpus) {
+  std::lock_guard<std::mutex> lock(mutexPool);
+  pool.reset();
+  poolCpus = cpus;
+  if (threads > 1) pool.reset(new ThreadPool(threads, cpus));
+}
+
+int inferenceThreads() { return pool ? pool->size() : 1; }
+
+bool pinInferenceThread() {
+  std::lock_guard<std::mutex> lock(mutexPool);
+  return !poolCpus.empty() && ThreadPool::pinCurrentThread(poolCpus[0]);
+}
+
+void parallelFor(int count, const std::function<void(int begin, int end)>& body) {
+  if (pool) {
+    pool->parallelFor(count, body);
+  } else if (count > 0) {
+    body(0, count);
+  }
+}
+
+} /* namespace darknet_ros*/
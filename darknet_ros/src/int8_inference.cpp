@@ -0,0 +1,372 @@
+/*
+ * int8_inference.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/int8_inference.hpp"
+
+// c++
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+// OpenCv
+#include <opencv2/highgui/highgui.hpp>
+
+// Image interface.
+#include "darknet_ros/image_interface.hpp"
+
+// Inference threads.
+#include "darknet_ros/inference_threads.hpp"
+
+// Darknet.
+extern "C" {
+#include "activations.h"
+#include "batchnorm_layer.h"
+#include "convolutional_layer.h"
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DARKNET_ROS_X86 1
+#if (defined(__clang__) && __clang_major__ >= 12) || (!defined(__clang__) && __GNUC__ >= 11)
+#define DARKNET_ROS_AVXVNNI 1
+#endif
+#endif
+
+namespace darknet_ros {
+
+namespace {
+
+// sums[j] = dot(a, row j of bt) for n rows of kpad int8 values.
+typedef void (*DotRows)(const int8_t* a, const int8_t* bt, int n, int kpad, int32_t* sums);
+
+void dotRowsScalar(const int8_t* a, const int8_t* bt, int n, int kpad, int32_t* sums) {
+  for (int j = 0; j < n; ++j) {
+    const int8_t* b = bt + static_cast<size_t>(j) * kpad;
+    int32_t sum = 0;
+    for (int k = 0; k < kpad; ++k) sum += a[k] * b[k];
+    sums[j] = sum;
+  }
+}
+
+#ifdef DARKNET_ROS_X86
+__attribute__((target("avx2"))) inline int32_t horizontalSum(__m256i v) {
+  __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(s);
+}
+
+// The byte multiplies take one unsigned operand: |a| is multiplied by b with
+// the sign of a moved onto it, which is exact as both are within [-127, 127].
+__attribute__((target("avx2"))) inline __m256i dotAvx2(__m256i sum, __m256i absA, __m256i signA, const int8_t* b) {
+  const __m256i product = _mm256_maddubs_epi16(absA, _mm256_sign_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)), signA));
+  return _mm256_add_epi32(sum, _mm256_madd_epi16(product, _mm256_set1_epi16(1)));
+}
+
+__attribute__((target("avx2"))) void dotRowsAvx2(const int8_t* a, const int8_t* bt, int n, int kpad, int32_t* sums) {
+  int j = 0;
+  for (; j + 4 <= n; j += 4) {
+    const int8_t* b = bt + static_cast<size_t>(j) * kpad;
+    __m256i sum0 = _mm256_setzero_si256(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+    for (int k = 0; k < kpad; k += kInt8Block) {
+      const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + k));
+      const __m256i absA = _mm256_sign_epi8(va, va);
+      sum0 = dotAvx2(sum0, absA, va, b + k);
+      sum1 = dotAvx2(sum1, absA, va, b + kpad + k);
+      sum2 = dotAvx2(sum2, absA, va, b + 2 * kpad + k);
+      sum3 = dotAvx2(sum3, absA, va, b + 3 * kpad + k);
+    }
+    sums[j] = horizontalSum(sum0);
+    sums[j + 1] = horizontalSum(sum1);
+    sums[j + 2] = horizontalSum(sum2);
+    sums[j + 3] = horizontalSum(sum3);
+  }
+  for (; j < n; ++j) {
+    const int8_t* b = bt + static_cast<size_t>(j) * kpad;
+    __m256i sum = _mm256_setzero_si256();
+    for (int k = 0; k < kpad; k += kInt8Block) {
+      const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + k));
+      sum = dotAvx2(sum, _mm256_sign_epi8(va, va), va, b + k);
+    }
+    sums[j] = horizontalSum(sum);
+  }
+}
+
+#ifdef DARKNET_ROS_AVXVNNI
+// Same as dotRowsAvx2 with the multiply and both additions in one instruction.
+__attribute__((target("avx2,avxvnni"))) inline __m256i dotVnni(__m256i sum, __m256i absA, __m256i signA, const int8_t* b) {
+  return _mm256_dpbusd_avx_epi32(sum, absA, _mm256_sign_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)), signA));
+}
+
+__attribute__((target("avx2,avxvnni"))) void dotRowsVnni(const int8_t* a, const int8_t* bt, int n, int kpad, int32_t* sums) {
+  int j = 0;
+  for (; j + 4 <= n; j += 4) {
+    const int8_t* b = bt + static_cast<size_t>(j) * kpad;
+    __m256i sum0 = _mm256_setzero_si256(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+    for (int k = 0; k < kpad; k += kInt8Block) {
+      const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + k));
+      const __m256i absA = _mm256_sign_epi8(va, va);
+      sum0 = dotVnni(sum0, absA, va, b + k);
+      sum1 = dotVnni(sum1, absA, va, b + kpad + k);
+      sum2 = dotVnni(sum2, absA, va, b + 2 * kpad + k);
+      sum3 = dotVnni(sum3, absA, va, b + 3 * kpad + k);
+    }
+    sums[j] = horizontalSum(sum0);
+    sums[j + 1] = horizontalSum(sum1);
+    sums[j + 2] = horizontalSum(sum2);
+    sums[j + 3] = horizontalSum(sum3);
+  }
+  for (; j < n; ++j) {
+    const int8_t* b = bt + static_cast<size_t>(j) * kpad;
+    __m256i sum = _mm256_setzero_si256();
+    for (int k = 0; k < kpad; k += kInt8Block) {
+      const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + k));
+      sum = dotVnni(sum, _mm256_sign_epi8(va, va), va, b + k);
+    }
+    sums[j] = horizontalSum(sum);
+  }
+}
+#endif
+#endif
+
+struct Int8Kernel {
+  DotRows dotRows;
+  const char* name;
+};
+
+// Picked once at runtime, so the package still runs on CPUs without AVX2.
+const Int8Kernel& int8Kernel() {
+  static const Int8Kernel kernel = [] {
+#ifdef DARKNET_ROS_X86
+#ifdef DARKNET_ROS_AVXVNNI
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("avxvnni")) return Int8Kernel{dotRowsVnni, "avxvnni"};
+#endif
+    if (__builtin_cpu_supports("avx2")) return Int8Kernel{dotRowsAvx2, "avx2"};
+#endif
+    return Int8Kernel{dotRowsScalar, "scalar"};
+  }();
+  return kernel;
+}
+
+inline int8_t quantize(float value) {
+  const long q = lrintf(value);
+  return static_cast<int8_t>(std::max(-127l, std::min(q, 127l)));
+}
+
+// INT8 weights of a convolutional layer, its FP32 weights stay in the layer.
+struct QuantizedLayer {
+  std::vector<int8_t> weights;  // n x kpad
+  std::vector<float> scales;    // per output channel
+  float inputScale;
+  int kpad;
+  void (*forward)(layer, network);  // of the layer before quantization
+};
+
+// Keyed by the FP32 weights of the layer, which identify it in its forward function.
+std::map<const float*, QuantizedLayer> quantizedLayers;
+std::mutex mutexQuantizedLayers;
+
+// Largest input magnitude of each layer seen by the running calibration.
+std::map<const float*, float>* calibrationRanges = NULL;
+std::mutex mutexCalibration;
+
+// Fraction of the inputs of a layer within its calibrated range, the few
+// outliers beyond it are clipped instead of coarsening all other steps.
+const double kCalibrationQuantile = 0.9999;
+
+// Forward function of the layers during calibration.
+void recordInputRange(layer l, network net) {
+  thread_local std::vector<float> magnitudes;
+  magnitudes.resize(l.inputs);
+  for (int i = 0; i < l.inputs; ++i) magnitudes[i] = std::fabs(net.input[i]);
+  const size_t index = std::min<size_t>(l.inputs - 1, kCalibrationQuantile * l.inputs);
+  std::nth_element(magnitudes.begin(), magnitudes.begin() + index, magnitudes.end());
+  float& range = (*calibrationRanges)[l.weights];
+  range = std::max(range, magnitudes[index]);
+  forward_convolutional_layer(l, net);
+}
+
+// Quantized im2col of the output rows [y0, y1) of one input image, transposed
+// so that the inputs of each output pixel are contiguous and zero padded to kpad.
+void quantizeColumns(const float* input, const layer& l, float inverseScale, int kpad, int y0, int y1, int8_t* columns) {
+  for (int y = y0; y < y1; ++y) {
+    for (int x = 0; x < l.out_w; ++x) {
+      int8_t* out = columns + static_cast<size_t>(y * l.out_w + x) * kpad;
+      int k = 0;
+      for (int c = 0; c < l.c; ++c) {
+        for (int ky = 0; ky < l.size; ++ky) {
+          const int iy = y * l.stride + ky - l.pad;
+          const float* row = input + (static_cast<size_t>(c) * l.h + iy) * l.w;
+          for (int kx = 0; kx < l.size; ++kx, ++k) {
+            const int ix = x * l.stride + kx - l.pad;
+            out[k] = (iy < 0 || iy >= l.h || ix < 0 || ix >= l.w) ? 0 : quantize(row[ix] * inverseScale);
+          }
+        }
+      }
+      memset(out + k, 0, kpad - k);
+    }
+  }
+}
+
+// Replaces forward_convolutional_layer for the quantized layers.
+void forwardConvolutionalInt8(layer l, network net) {
+  const QuantizedLayer* quantized = NULL;
+  {
+    std::lock_guard<std::mutex> lock(mutexQuantizedLayers);
+    const auto it = quantizedLayers.find(l.weights);
+    if (it != quantizedLayers.end()) quantized = &it->second;
+  }
+  if (!quantized) {
+    forward_convolutional_layer(l, net);
+    return;
+  }
+  const int pixels = l.out_w * l.out_h;
+  thread_local std::vector<int8_t> columns;
+  columns.resize(static_cast<size_t>(pixels) * quantized->kpad);
+  // The workers have thread_locals of their own, they write through the
+  // pointer to the calling thread's buffer.
+  int8_t* const columnData = columns.data();
+  for (int b = 0; b < l.batch; ++b) {
+    const float* input = net.input + static_cast<size_t>(b) * l.inputs;
+    parallelFor(l.out_h, [&](int y0, int y1) {
+      quantizeColumns(input, l, 1.f / quantized->inputScale, quantized->kpad, y0, y1, columnData);
+    });
+    // Biases of layers without batch normalization are added by the GEMM.
+    gemmInt8(l.n, pixels, quantized->kpad, quantized->weights.data(), columnData, quantized->scales.data(), quantized->inputScale,
+             l.batch_normalize ? NULL : l.biases, l.output + static_cast<size_t>(b) * l.outputs);
+  }
+  if (l.batch_normalize) forward_batchnorm_layer(l, net);
+  parallelFor(l.outputs * l.batch, [&](int i0, int i1) { activate_array(l.output + i0, i1 - i0, l.activation); });
+}
+
+}  // namespace
+
+void quantizeRows(const float* values, int rows, int k, int kpad, int8_t* quantized, float* scales) {
+  for (int r = 0; r < rows; ++r) {
+    const float* row = values + static_cast<size_t>(r) * k;
+    int8_t* out = quantized + static_cast<size_t>(r) * kpad;
+    float range = 0;
+    for (int i = 0; i < k; ++i) range = std::max(range, std::fabs(row[i]));
+    scales[r] = range / 127;
+    const float inverseScale = range > 0 ? 127 / range : 0;
+    for (int i = 0; i < k; ++i) out[i] = quantize(row[i] * inverseScale);
+    memset(out + k, 0, kpad - k);
+  }
+}
+
+void gemmInt8(int m, int n, int kpad, const int8_t* a, const int8_t* bt, const float* scales, float inputScale, const float* biases, float* c) {
+  const DotRows dotRows = int8Kernel().dotRows;
+  // Blocks of bt stay in cache while all rows of a pass over them, the
+  // inference threads take one range of blocks each.
+  const int kBlock = 64;
+  parallelFor((n + kBlock - 1) / kBlock, [&](int block0, int block1) {
+    int32_t sums[kBlock];
+    for (int j0 = block0 * kBlock; j0 < std::min(n, block1 * kBlock); j0 += kBlock) {
+      const int columns = std::min(kBlock, n - j0);
+      for (int i = 0; i < m; ++i) {
+        dotRows(a + static_cast<size_t>(i) * kpad, bt + static_cast<size_t>(j0) * kpad, columns, kpad, sums);
+        const float scale = scales[i] * inputScale;
+        const float bias = biases ? biases[i] : 0.f;
+        float* out = c + static_cast<size_t>(i) * n + j0;
+        for (int j = 0; j < columns; ++j) out[j] = sums[j] * scale + bias;
+      }
+    }
+  });
+}
+
+const char* int8KernelName() { return int8Kernel().name; }
+
+int quantizeNetwork(network* net, const std::vector<std::string>& calibrationImages, std::string& error) {
+#ifdef GPU
+  if (gpu_index >= 0) {
+    error = "INT8 inference runs on the CPU only";
+    return -1;
+  }
+#endif
+  if (calibrationImages.empty()) {
+    error = "no calibration images";
+    return -1;
+  }
+
+  // The first convolution sees the image itself and stays in FP32.
+  std::vector<int> layers;
+  bool first = true;
+  for (int i = 0; i < net->n; ++i) {
+    const layer& l = net->layers[i];
+    if (l.type != CONVOLUTIONAL) continue;
+    if (!first && l.groups <= 1 && !l.binary && !l.xnor) layers.push_back(i);
+    first = false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutexCalibration);
+  std::map<const float*, float> ranges;
+  calibrationRanges = &ranges;
+  std::vector<void (*)(layer, network)> forwards;
+  for (int i : layers) {
+    forwards.push_back(net->layers[i].forward);
+    net->layers[i].forward = recordInputRange;
+  }
+
+  // Same preprocessing as YoloObjectDetector, into the first image of the batch.
+  std::vector<float> batch(static_cast<size_t>(net->batch) * net->inputs, 0.f);
+  image input = {net->w, net->h, net->c, batch.data()};
+  letterbox_plan plan = make_letterbox_plan();
+  const int channelSwap = !mat_to_image_swaps_rb();
+  int calibrated = 0;
+  for (const std::string& path : calibrationImages) {
+    const cv::Mat mat = cv::imread(path, cv::IMREAD_COLOR);
+    if (mat.empty()) continue;
+    letterbox_mat_into(mat, channelSwap, input, &plan);
+    network_predict(net, input.data);
+    ++calibrated;
+  }
+  free_letterbox_plan(&plan);
+  for (size_t i = 0; i < layers.size(); ++i) net->layers[layers[i]].forward = forwards[i];
+  calibrationRanges = NULL;
+  if (!calibrated) {
+    error = "none of the calibration images could be read";
+    return -1;
+  }
+
+  int count = 0;
+  for (int i : layers) {
+    layer& l = net->layers[i];
+    const float range = ranges[l.weights];
+    if (!(range > 0)) continue;  // inputs always zero, nothing to calibrate
+    const int k = l.c * l.size * l.size;
+    QuantizedLayer quantized;
+    quantized.kpad = paddedDepth(k);
+    quantized.inputScale = range / 127;
+    quantized.forward = l.forward;
+    quantized.weights.resize(static_cast<size_t>(l.n) * quantized.kpad);
+    quantized.scales.resize(l.n);
+    quantizeRows(l.weights, l.n, k, quantized.kpad, quantized.weights.data(), quantized.scales.data());
+    {
+      std::lock_guard<std::mutex> registryLock(mutexQuantizedLayers);
+      quantizedLayers[l.weights] = std::move(quantized);
+    }
+    l.forward = forwardConvolutionalInt8;
+    ++count;
+  }
+  return count;
+}
+
+void releaseQuantizedNetwork(network* net) {
+  std::lock_guard<std::mutex> lock(mutexQuantizedLayers);
+  for (int i = 0; i < net->n; ++i) {
+    layer& l = net->layers[i];
+    if (l.forward != forwardConvolutionalInt8) continue;
+    const auto it = quantizedLayers.find(l.weights);
+    if (it == quantizedLayers.end()) continue;
+    l.forward = it->second.forward;
+    quantizedLayers.erase(it);
+  }
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,80 @@
+/*
+ * motion_gate.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/motion_gate.hpp"
+
+// c++
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace darknet_ros {
+
+namespace {
+
+// Pixels sampled per block side.
+const int kSamplesPerSide = 8;
+
+}  // namespace
+
+MotionGate::MotionGate(int columns, double threshold, double changedFraction, int refreshInterval)
+    : columns_(std::max(columns, 1)),
+      threshold_(threshold),
+      changedFraction_(changedFraction),
+      refreshInterval_(refreshInterval),
+      unchangedFrames_(0) {
+  // Enough for frames up to square, so landscape frames never reallocate.
+  reference_.reserve(columns_ * columns_);
+  current_.reserve(columns_ * columns_);
+  counts_.reserve(columns_ * columns_);
+}
+
+void MotionGate::measure(const cv::Mat& frame, std::vector<float>& blocks) {
+  assert(frame.type() == CV_8UC3);
+  const int blockSize = std::max(1, frame.cols / columns_);
+  const int columns = std::max(1, frame.cols / blockSize);
+  const int rows = std::max(1, frame.rows / blockSize);
+  const int step = std::max(1, blockSize / kSamplesPerSide);
+  blocks.assign(columns * rows, 0.f);
+  counts_.resize(columns * rows);
+  std::fill(counts_.begin(), counts_.end(), 0);
+  for (int y = step / 2; y < rows * blockSize && y < frame.rows; y += step) {
+    const unsigned char* row = frame.ptr<unsigned char>(y);
+    const int blockRow = (y / blockSize) * columns;
+    for (int x = step / 2; x < columns * blockSize && x < frame.cols; x += step) {
+      const unsigned char* pixel = row + 3 * x;
+      const int block = blockRow + x / blockSize;
+      blocks[block] += pixel[0] + pixel[1] + pixel[2];
+      ++counts_[block];
+    }
+  }
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    blocks[i] /= 3.f * std::max(counts_[i], 1);
+  }
+}
+
+bool MotionGate::changed(const cv::Mat& frame) {
+  measure(frame, current_);
+  bool changed = frame.size() != referenceSize_ || current_.size() != reference_.size();
+  if (!changed) {
+    size_t blocks = 0;
+    for (size_t i = 0; i < current_.size(); ++i) {
+      if (std::fabs(current_[i] - reference_[i]) > threshold_) ++blocks;
+    }
+    changed = blocks > 0 && blocks >= changedFraction_ * current_.size();
+  }
+  if (!changed && (refreshInterval_ <= 0 || unchangedFrames_ < refreshInterval_)) {
+    ++unchangedFrames_;
+    return false;
+  }
+  unchangedFrames_ = 0;
+  referenceSize_ = frame.size();
+  reference_.swap(current_);
+  return true;
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,332 @@
+/*
+ * network_blob.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/network_blob.hpp"
+
+// c++
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+#ifdef GPU
+extern "C" {
+#include "batchnorm_layer.h"
+#include "connected_layer.h"
+#include "convolutional_layer.h"
+#include "deconvolutional_layer.h"
+}
+#endif
+
+namespace darknet_ros {
+
+namespace {
+
+const char kMagic[8] = {'D', 'N', 'R', 'O', 'S', 'N', 'B', '\0'};
+
+// Weight arrays start on cache lines.
+const uint64_t kAlignment = 64;
+
+enum LayerArray { BIASES, SCALES, ROLLING_MEAN, ROLLING_VARIANCE, WEIGHTS, NUM_LAYER_ARRAYS };
+
+// The file starts with the header, followed by the cfg text, one BlobLayer
+// per layer of the network and the weight arrays they point to.
+struct BlobHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t numLayers;
+  uint64_t cfgOffset;
+  uint64_t cfgSize;
+  uint64_t layersOffset;
+  uint64_t fileSize;
+  uint64_t checksum;  // of all bytes after the header
+};
+
+struct BlobLayer {
+  int32_t type;
+  int32_t batchNormalize;  // 0 for convolutions whose batch normalization was folded by foldBatchNorm
+  uint32_t counts[NUM_LAYER_ARRAYS];   // number of floats, 0 if the layer has no such array
+  uint64_t offsets[NUM_LAYER_ARRAYS];  // from the start of the file
+};
+
+// Mapped blobs of the networks of loadNetworkBlob.
+struct Mapping {
+  char* data;
+  size_t size;
+};
+std::map<network*, Mapping> mappings;
+std::mutex mutexMappings;
+
+uint64_t align(uint64_t offset) { return (offset + kAlignment - 1) / kAlignment * kAlignment; }
+
+// FNV-1a over 64 bit words, the bytes of a partial last word are hashed one by one.
+uint64_t checksum(const char* data, size_t size) {
+  const uint64_t prime = 1099511628211ull;
+  uint64_t hash = 14695981039346656037ull;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * prime;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+  }
+  return hash;
+}
+
+// Weight arrays of a layer and their lengths, as read by darknet's load_weights.
+// @return false for layer types with weights that blobs do not support.
+bool layerArrays(layer* l, float** arrays[], uint32_t counts[]) {
+  for (int i = 0; i < NUM_LAYER_ARRAYS; ++i) {
+    arrays[i] = NULL;
+    counts[i] = 0;
+  }
+  int outputs;
+  switch (l->type) {
+    case CONVOLUTIONAL:
+    case DECONVOLUTIONAL:
+      outputs = l->n;
+      arrays[WEIGHTS] = &l->weights;
+      counts[WEIGHTS] = l->nweights;
+      break;
+    case CONNECTED:
+      outputs = l->outputs;
+      arrays[WEIGHTS] = &l->weights;
+      counts[WEIGHTS] = l->outputs * l->inputs;
+      break;
+    case BATCHNORM:
+      arrays[SCALES] = &l->scales;
+      arrays[ROLLING_MEAN] = &l->rolling_mean;
+      arrays[ROLLING_VARIANCE] = &l->rolling_variance;
+      counts[SCALES] = counts[ROLLING_MEAN] = counts[ROLLING_VARIANCE] = l->c;
+      return true;
+    case LOCAL:
+    case RNN:
+    case GRU:
+    case LSTM:
+    case CRNN:
+      return false;
+    default:
+      return true;
+  }
+  arrays[BIASES] = &l->biases;
+  counts[BIASES] = outputs;
+  if (l->batch_normalize) {
+    arrays[SCALES] = &l->scales;
+    arrays[ROLLING_MEAN] = &l->rolling_mean;
+    arrays[ROLLING_VARIANCE] = &l->rolling_variance;
+    counts[SCALES] = counts[ROLLING_MEAN] = counts[ROLLING_VARIANCE] = outputs;
+  }
+  return true;
+}
+
+// Copies the weights pointed to by the layers to the GPU, as load_weights does.
+void pushLayers(network* net) {
+#ifdef GPU
+  if (gpu_index < 0) return;
+  for (int i = 0; i < net->n; ++i) {
+    layer l = net->layers[i];
+    if (l.type == CONVOLUTIONAL) push_convolutional_layer(l);
+    if (l.type == DECONVOLUTIONAL) push_deconvolutional_layer(l);
+    if (l.type == CONNECTED) push_connected_layer(l);
+    if (l.type == BATCHNORM) push_batchnorm_layer(l);
+  }
+#endif
+}
+
+}  // namespace
+
+bool writeNetworkBlob(network* net, const char* cfgfile, const char* blobfile, std::string& error) {
+  std::ifstream cfgIn(cfgfile);
+  std::stringstream cfg;
+  cfg << cfgIn.rdbuf();
+  if (!cfgIn) {
+    error = std::string("cannot read ") + cfgfile;
+    return false;
+  }
+  const std::string cfgText = cfg.str();
+
+  BlobHeader header = {};
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kNetworkBlobVersion;
+  header.numLayers = net->n;
+  header.cfgOffset = sizeof(BlobHeader);
+  header.cfgSize = cfgText.size();
+  header.layersOffset = align(header.cfgOffset + header.cfgSize);
+
+  std::vector<BlobLayer> layers(net->n);
+  uint64_t offset = align(header.layersOffset + layers.size() * sizeof(BlobLayer));
+  for (int i = 0; i < net->n; ++i) {
+    float** arrays[NUM_LAYER_ARRAYS];
+    layers[i].type = net->layers[i].type;
+    layers[i].batchNormalize = net->layers[i].batch_normalize;
+    if (!layerArrays(&net->layers[i], arrays, layers[i].counts)) {
+      std::ostringstream message;
+      message << "layer " << i << " is of a type with weights that network blobs do not support";
+      error = message.str();
+      return false;
+    }
+    for (int a = 0; a < NUM_LAYER_ARRAYS; ++a) {
+      layers[i].offsets[a] = layers[i].counts[a] ? offset : 0;
+      offset = align(offset + layers[i].counts[a] * sizeof(float));
+    }
+  }
+  header.fileSize = offset;
+
+  std::vector<char> blob(header.fileSize, 0);
+  memcpy(&blob[header.cfgOffset], cfgText.data(), cfgText.size());
+  memcpy(&blob[header.layersOffset], layers.data(), layers.size() * sizeof(BlobLayer));
+  for (int i = 0; i < net->n; ++i) {
+    float** arrays[NUM_LAYER_ARRAYS];
+    uint32_t counts[NUM_LAYER_ARRAYS];
+    layerArrays(&net->layers[i], arrays, counts);
+    for (int a = 0; a < NUM_LAYER_ARRAYS; ++a) {
+      if (counts[a]) memcpy(&blob[layers[i].offsets[a]], *arrays[a], counts[a] * sizeof(float));
+    }
+  }
+  header.checksum = checksum(blob.data() + sizeof(BlobHeader), blob.size() - sizeof(BlobHeader));
+  memcpy(blob.data(), &header, sizeof(header));
+
+  std::ofstream out(blobfile, std::ios::binary);
+  out.write(blob.data(), blob.size());
+  out.close();
+  if (!out) {
+    error = std::string("cannot write ") + blobfile;
+    return false;
+  }
+  return true;
+}
+
+network* loadNetworkBlob(const char* blobfile, int batch, std::string& error) {
+  const int fd = open(blobfile, O_RDONLY);
+  struct stat status;
+  if (fd < 0 || fstat(fd, &status) != 0) {
+    if (fd >= 0) close(fd);
+    error = std::string("cannot open ") + blobfile;
+    return NULL;
+  }
+  const size_t size = status.st_size;
+  if (size < sizeof(BlobHeader)) {
+    close(fd);
+    error = "file is too short";
+    return NULL;
+  }
+  // Private and writable, pages stay shared with the page cache until written.
+  char* data = static_cast<char*>(mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0));
+  close(fd);
+  if (data == MAP_FAILED) {
+    error = std::string("cannot map ") + blobfile;
+    return NULL;
+  }
+  const auto fail = [&](const std::string& reason) -> network* {
+    munmap(data, size);
+    error = reason;
+    return NULL;
+  };
+
+  BlobHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) return fail("not a network blob");
+  if (header.version != kNetworkBlobVersion) {
+    std::ostringstream message;
+    message << "blob version " << header.version << " instead of " << kNetworkBlobVersion << ", convert the network again";
+    return fail(message.str());
+  }
+  if (header.fileSize != size || header.cfgOffset + header.cfgSize > size ||
+      header.layersOffset + uint64_t(header.numLayers) * sizeof(BlobLayer) > size) {
+    return fail("file is truncated");
+  }
+  if (checksum(data + sizeof(BlobHeader), size - sizeof(BlobHeader)) != header.checksum) return fail("checksum mismatch");
+
+  const BlobLayer* layers = reinterpret_cast<const BlobLayer*>(data + header.layersOffset);
+  network* net = parseNetworkWithBatch(std::string(data + header.cfgOffset, header.cfgSize), std::max(batch, 1));
+  if (net->n != static_cast<int>(header.numLayers)) {
+    free_network(net);
+    return fail("layers do not match the cfg");
+  }
+
+  // All layers are checked before any of them is changed. Folded layers have
+  // no batch normalization arrays in the blob.
+  for (int i = 0; i < net->n; ++i) {
+    layer l = net->layers[i];
+    const bool folded = l.type == CONVOLUTIONAL && l.batch_normalize && !layers[i].batchNormalize;
+    if (folded) l.batch_normalize = 0;
+    float** arrays[NUM_LAYER_ARRAYS];
+    uint32_t counts[NUM_LAYER_ARRAYS];
+    layerArrays(&l, arrays, counts);
+    bool matches = layers[i].type == l.type && layers[i].batchNormalize == l.batch_normalize;
+    for (int a = 0; a < NUM_LAYER_ARRAYS; ++a) {
+      matches = matches && layers[i].counts[a] == counts[a] &&
+                (!counts[a] || (layers[i].offsets[a] % sizeof(float) == 0 && layers[i].offsets[a] + counts[a] * sizeof(float) <= size));
+    }
+    if (!matches) {
+      free_network(net);
+      std::ostringstream message;
+      message << "layer " << i << " does not match the cfg";
+      return fail(message.str());
+    }
+  }
+  for (int i = 0; i < net->n; ++i) {
+    net->layers[i].batch_normalize = layers[i].batchNormalize;
+    float** arrays[NUM_LAYER_ARRAYS];
+    uint32_t counts[NUM_LAYER_ARRAYS];
+    layerArrays(&net->layers[i], arrays, counts);
+    for (int a = 0; a < NUM_LAYER_ARRAYS; ++a) {
+      if (!counts[a]) continue;
+      free(*arrays[a]);
+      *arrays[a] = reinterpret_cast<float*>(data + layers[i].offsets[a]);
+    }
+  }
+  pushLayers(net);
+
+  std::lock_guard<std::mutex> lock(mutexMappings);
+  mappings[net] = Mapping{data, size};
+  return net;
+}
+
+void freeNetwork(network* net) {
+  Mapping mapping = {NULL, 0};
+  {
+    std::lock_guard<std::mutex> lock(mutexMappings);
+    const auto it = mappings.find(net);
+    if (it != mappings.end()) {
+      mapping = it->second;
+      mappings.erase(it);
+    }
+  }
+  if (mapping.data) {
+    // The mapped arrays are not free'd by free_network. They are found by
+    // address, as folding may have cleared batch_normalize since mapping.
+    const auto mapped = [&mapping](float* array) {
+      return reinterpret_cast<char*>(array) >= mapping.data && reinterpret_cast<char*>(array) < mapping.data + mapping.size;
+    };
+    for (int i = 0; i < net->n; ++i) {
+      layer& l = net->layers[i];
+      float** arrays[] = {&l.biases, &l.scales, &l.rolling_mean, &l.rolling_variance, &l.weights};
+      for (float** array : arrays) {
+        if (mapped(*array)) *array = NULL;
+      }
+    }
+  }
+  free_network(net);
+  if (mapping.data) munmap(mapping.data, mapping.size);
+}
+
+} /* namespace darknet_ros*/
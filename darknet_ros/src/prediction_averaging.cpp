@@ -0,0 +1,67 @@
+/*
+ * prediction_averaging.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+#include "darknet_ros/prediction_averaging.hpp"
+
+namespace darknet_ros {
+
+namespace {
+
+bool isDetectionLayer(const layer& l) {
+  return l.type == YOLO || l.type == REGION || l.type == DETECTION;
+}
+
+}  // namespace
+
+void PredictionAverager::resize(const network* net, int frames) {
+  frames_ = frames > 1 ? frames : 1;
+  total_ = 0;
+  for (int i = 0; i < net->n; ++i) {
+    const layer& l = net->layers[i];
+    if (isDetectionLayer(l)) total_ += l.outputs;
+  }
+  if (frames_ == 1) {
+    stored_.clear();
+    newest_.clear();
+    ring_.clear();
+    sum_.clear();
+    return;
+  }
+  stored_.assign(net->batch, 0);
+  newest_.assign(net->batch, 0);
+  ring_.assign(static_cast<size_t>(net->batch) * frames_ * total_, 0.f);
+  sum_.assign(static_cast<size_t>(net->batch) * total_, 0.);
+}
+
+void PredictionAverager::update(network* net, int first, int images) {
+  if (frames_ == 1) return;
+  for (int b = first; b < first + images && b < static_cast<int>(stored_.size()); ++b) {
+    // The slot of the oldest frame receives the newest one.
+    newest_[b] = (newest_[b] + 1) % frames_;
+    const bool full = stored_[b] == frames_;
+    if (!full) ++stored_[b];
+    const double scale = 1. / stored_[b];
+
+    float* stored = ring_.data() + (static_cast<size_t>(b) * frames_ + newest_[b]) * total_;
+    double* sum = sum_.data() + static_cast<size_t>(b) * total_;
+    for (int i = 0; i < net->n; ++i) {
+      const layer& l = net->layers[i];
+      if (!isDetectionLayer(l)) continue;
+      float* output = l.output + static_cast<size_t>(b) * l.outputs;
+      for (int k = 0; k < l.outputs; ++k) {
+        const float value = output[k];
+        sum[k] += full ? static_cast<double>(value) - stored[k] : value;
+        stored[k] = value;
+        output[k] = static_cast<float>(sum[k] * scale);
+      }
+      stored += l.outputs;
+      sum += l.outputs;
+    }
+  }
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,75 @@
+/*
+ * BatchNormFolding.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <unistd.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Batch normalization folding.
+#include "darknet_ros/batchnorm_folding.hpp"
+
+extern "C" {
+#include "parser.h"
+}
+
+namespace {
+
+// Batch normalized 3x3 and grouped 1x1 convolutions, and a plain one.
+const char* const kCfg =
+    "[net]\nbatch=1\nwidth=9\nheight=7\nchannels=3\n\n"
+    "[convolutional]\nbatch_normalize=1\nfilters=4\nsize=3\nstride=1\npad=1\nactivation=leaky\n\n"
+    "[convolutional]\nbatch_normalize=1\nfilters=6\nsize=1\nstride=1\npad=0\ngroups=2\nactivation=leaky\n\n"
+    "[convolutional]\nfilters=5\nsize=3\nstride=2\npad=1\nactivation=linear\n";
+
+void fillRandom(float* data, int n, float offset) {
+  for (int i = 0; i < n; ++i) data[i] = rand() / static_cast<float>(RAND_MAX) + offset;
+}
+
+}  // namespace
+
+TEST(BatchNormFolding, MatchesUnfoldedOutputs) {
+  char cfgFile[] = "/tmp/darknet_ros_folding_test_XXXXXX";
+  const int fd = mkstemp(cfgFile);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(static_cast<ssize_t>(strlen(kCfg)), write(fd, kCfg, strlen(kCfg)));
+  close(fd);
+  network* net = parse_network_cfg(cfgFile);
+  unlink(cfgFile);
+
+  srand(11);
+  for (int i = 0; i < net->n; ++i) {
+    layer& l = net->layers[i];
+    fillRandom(l.weights, l.nweights, -.5f);
+    fillRandom(l.biases, l.n, -.5f);
+    if (!l.batch_normalize) continue;
+    fillRandom(l.scales, l.n, .5f);
+    fillRandom(l.rolling_mean, l.n, -.5f);
+    fillRandom(l.rolling_variance, l.n, .1f);
+  }
+  std::vector<float> input(net->inputs);
+  fillRandom(input.data(), input.size(), 0.f);
+
+  const float* output = network_predict(net, input.data());
+  const std::vector<float> unfolded(output, output + net->outputs);
+
+  EXPECT_EQ(2, darknet_ros::foldBatchNorm(net));
+  for (int i = 0; i < net->n; ++i) EXPECT_EQ(0, net->layers[i].batch_normalize);
+  output = network_predict(net, input.data());
+  for (int i = 0; i < net->outputs; ++i) {
+    EXPECT_NEAR(unfolded[i], output[i], 1e-4 * (1 + std::fabs(unfolded[i]))) << "output " << i;
+  }
+
+  // Folding again leaves the network unchanged.
+  EXPECT_EQ(0, darknet_ros::foldBatchNorm(net));
+  free_network(net);
+}
@@ -0,0 +1,68 @@
+/*
+ * BoxMessages.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <string>
+#include <vector>
+
+// darknet_ros_msgs
+#include <darknet_ros_msgs/BoundingBoxes.h>
+
+// Messages of the publish stage.
+#include "darknet_ros/box_messages.hpp"
+
+using darknet_ros::RosBox_;
+
+TEST(BoxMessages, FillsCrowdedFrames) {
+  const std::vector<std::string> labels = {"person", "car", "dog"};
+  std::vector<RosBox_> boxes(600);
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    boxes[i].x = .5f;
+    boxes[i].y = .25f;
+    boxes[i].w = .2f;
+    boxes[i].h = .1f;
+    boxes[i].prob = .75f;
+    boxes[i].Class = i % labels.size();
+    boxes[i].id = 1000 + i;
+  }
+  // No label for the last box.
+  boxes.back().Class = labels.size();
+
+  std::vector<darknet_ros_msgs::BoundingBox> boundingBoxes;
+  ASSERT_EQ(599, darknet_ros::fillBoundingBoxes(boxes.data(), boxes.size(), 640, 480, labels, false, boundingBoxes));
+  ASSERT_EQ(599u, boundingBoxes.size());
+  const darknet_ros_msgs::BoundingBox& boundingBox = boundingBoxes[4];
+  EXPECT_EQ("car", boundingBox.Class);
+  EXPECT_EQ(1, boundingBox.id);
+  EXPECT_DOUBLE_EQ(.75, boundingBox.probability);
+  EXPECT_EQ(256, boundingBox.xmin);
+  EXPECT_EQ(384, boundingBox.xmax);
+  EXPECT_EQ(96, boundingBox.ymin);
+  EXPECT_EQ(144, boundingBox.ymax);
+
+  // Track ids, and fewer boxes in the same array.
+  const darknet_ros_msgs::BoundingBox* data = boundingBoxes.data();
+  ASSERT_EQ(10, darknet_ros::fillBoundingBoxes(boxes.data(), 10, 640, 480, labels, true, boundingBoxes));
+  EXPECT_EQ(1004, boundingBoxes[4].id);
+  EXPECT_EQ(data, boundingBoxes.data());
+}
+
+TEST(BoxMessages, RecyclesMessagesNobodyHolds) {
+  darknet_ros_msgs::BoundingBoxesPtr message;
+  darknet_ros::recycleMessage(message)->bounding_boxes.resize(500);
+  const darknet_ros_msgs::BoundingBoxes* first = message.get();
+  EXPECT_EQ(first, darknet_ros::recycleMessage(message).get());
+  EXPECT_EQ(500u, message->bounding_boxes.capacity());
+
+  // A subscriber still holds the message.
+  darknet_ros_msgs::BoundingBoxesPtr held = message;
+  EXPECT_NE(first, darknet_ros::recycleMessage(message).get());
+  EXPECT_EQ(500u, held->bounding_boxes.size());
+}
@@ -0,0 +1,117 @@
+/*
+ * BoxPostprocessing.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+// Post-processing of the decoded detections.
+#include "darknet_ros/box_postprocessing.hpp"
+
+using darknet_ros::BoxPostprocessor;
+using darknet_ros::RosBox_;
+
+namespace {
+
+// Detections as get_network_boxes returns them, probabilities not above
+// thresh are zero.
+std::vector<detection> makeDetections(const std::vector<box>& boxes, const std::vector<std::vector<float>>& probs, float thresh) {
+  std::vector<detection> dets(boxes.size());
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    dets[i].bbox = boxes[i];
+    dets[i].classes = probs[i].size();
+    dets[i].prob = static_cast<float*>(calloc(probs[i].size(), sizeof(float)));
+    dets[i].mask = 0;
+    dets[i].objectness = *std::max_element(probs[i].begin(), probs[i].end());
+    dets[i].sort_class = 0;
+    for (size_t j = 0; j < probs[i].size(); ++j) {
+      if (probs[i][j] > thresh) dets[i].prob[j] = probs[i][j];
+    }
+  }
+  return dets;
+}
+
+void freeDetections(std::vector<detection>& dets) {
+  for (detection& det : dets) free(det.prob);
+}
+
+}  // namespace
+
+TEST(BoxPostprocessing, SuppressesWithinClassOnly) {
+  const box a = {.5f, .5f, .2f, .2f};
+  const box b = {.51f, .5f, .2f, .2f};
+  const box c = {.2f, .2f, .1f, .1f};
+  std::vector<detection> dets = makeDetections({a, b, b, c}, {{.9f, 0}, {.8f, 0}, {0, .7f}, {.1f, .6f}}, .3f);
+
+  BoxPostprocessor postprocessor;
+  ASSERT_EQ(3, postprocessor.run(dets.data(), dets.size(), 2, .3f, .45f));
+  const darknet_ros::BoxArrays_& boxes = postprocessor.boxes();
+  EXPECT_EQ(0, boxes.Class[0]);
+  EXPECT_FLOAT_EQ(.9f, boxes.prob[0]);
+  EXPECT_EQ(1, boxes.Class[1]);
+  EXPECT_FLOAT_EQ(.7f, boxes.prob[1]);
+  EXPECT_EQ(1, boxes.Class[2]);
+  EXPECT_FLOAT_EQ(.6f, boxes.prob[2]);
+
+  RosBox_ roiBoxes[3];
+  EXPECT_EQ(2, postprocessor.extract(roiBoxes, 2));
+  ASSERT_EQ(3, postprocessor.extract(roiBoxes, 3));
+  EXPECT_EQ(3, roiBoxes[0].num);
+  EXPECT_FLOAT_EQ(.2f, roiBoxes[2].x);
+  EXPECT_FLOAT_EQ(.1f, roiBoxes[2].w);
+
+  // Nothing above the threshold.
+  EXPECT_EQ(0, postprocessor.run(dets.data(), dets.size(), 2, .95f, .45f));
+  freeDetections(dets);
+}
+
+TEST(BoxPostprocessing, MatchesSortedNmsOnDenseScene) {
+  const int classes = 20;
+  const float thresh = .3f;
+  const float nms = .45f;
+  srand(1);
+  std::vector<box> boxes;
+  std::vector<std::vector<float>> probs;
+  for (int i = 0; i < 1500; ++i) {
+    // Clusters of boxes around a few objects.
+    const int object = rand() % 12;
+    box b;
+    b.x = .1f + .07f * object + .03f * rand() / RAND_MAX;
+    b.y = .2f + .05f * (object % 5) + .03f * rand() / RAND_MAX;
+    b.w = .05f + .1f * rand() / RAND_MAX;
+    b.h = .05f + .1f * rand() / RAND_MAX;
+    boxes.push_back(b);
+    std::vector<float> prob(classes);
+    for (float& p : prob) p = (rand() % 4 == 0) ? static_cast<float>(rand()) / RAND_MAX : 0;
+    probs.push_back(prob);
+  }
+  std::vector<detection> dets = makeDetections(boxes, probs, thresh);
+
+  BoxPostprocessor postprocessor;
+  postprocessor.run(dets.data(), dets.size(), classes, thresh, nms);
+  std::vector<std::tuple<int, float, float, float>> kept;
+  const darknet_ros::BoxArrays_& arrays = postprocessor.boxes();
+  for (size_t i = 0; i < arrays.size(); ++i) kept.emplace_back(arrays.Class[i], arrays.prob[i], arrays.x[i], arrays.y[i]);
+
+  do_nms_sort(dets.data(), dets.size(), classes, nms);
+  std::vector<std::tuple<int, float, float, float>> expected;
+  for (const detection& det : dets) {
+    for (int j = 0; j < classes; ++j) {
+      if (det.prob[j] > thresh) expected.emplace_back(j, det.prob[j], det.bbox.x, det.bbox.y);
+    }
+  }
+  std::sort(kept.begin(), kept.end());
+  std::sort(expected.begin(), expected.end());
+  EXPECT_LT(100u, expected.size());
+  EXPECT_EQ(expected, kept);
+  freeDetections(dets);
+}
@@ -0,0 +1,102 @@
+/*
+ * BoxTracking.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <vector>
+
+// OpenCv
+#include <opencv2/imgproc/imgproc.hpp>
+
+// Box tracking between keyframes.
+#include "darknet_ros/box_tracking.hpp"
+
+using darknet_ros::BoxTracker;
+using darknet_ros::RosBox_;
+
+namespace {
+
+RosBox_ makeBox(float x, float y, float w, float h, int Class) {
+  RosBox_ box = {};
+  box.x = x;
+  box.y = y;
+  box.w = w;
+  box.h = h;
+  box.prob = .9f;
+  box.Class = Class;
+  return box;
+}
+
+// Smooth random texture that optical flow can follow.
+cv::Mat texture(int width, int height) {
+  cv::Mat image(height, width, CV_8UC1);
+  cv::randu(image, 0, 255);
+  cv::GaussianBlur(image, image, cv::Size(5, 5), 1.5);
+  return image;
+}
+
+}  // namespace
+
+TEST(BoxTracking, DetectionsKeepTheIdsOfTheirTracks) {
+  const cv::Mat gray(120, 160, CV_8UC1, cv::Scalar(0));
+  BoxTracker tracker(2, 8, .5);
+  std::vector<RosBox_> first = {makeBox(.3f, .3f, .2f, .2f, 0), makeBox(.7f, .7f, .2f, .2f, 1)};
+  tracker.update(first.data(), first.size(), gray);
+  EXPECT_NE(first[0].id, first[1].id);
+
+  // Moved a little, a new box of the class of the first box, and the second box is gone.
+  std::vector<RosBox_> second = {makeBox(.32f, .3f, .2f, .2f, 0), makeBox(.7f, .7f, .2f, .2f, 0)};
+  tracker.update(second.data(), second.size(), gray);
+  EXPECT_EQ(first[0].id, second[0].id);
+  EXPECT_NE(first[0].id, second[1].id);
+  EXPECT_NE(first[1].id, second[1].id);
+  EXPECT_EQ(2, tracker.size());
+}
+
+TEST(BoxTracking, BoxesFollowTheImage) {
+  const cv::Mat scene = texture(240, 180);
+  const cv::Mat before = scene(cv::Rect(20, 20, 200, 150));
+  // The scene moves 4 pixels to the right and 2 pixels down.
+  const cv::Mat after = scene(cv::Rect(16, 18, 200, 150));
+
+  BoxTracker tracker(2, 8, .5);
+  std::vector<RosBox_> boxes = {makeBox(.5f, .5f, .3f, .3f, 0)};
+  tracker.update(boxes.data(), boxes.size(), before);
+  EXPECT_GT(tracker.propagate(after), .9);
+
+  std::vector<RosBox_> tracked(1);
+  ASSERT_EQ(1, tracker.boxes(tracked.data()));
+  EXPECT_EQ(1, tracked[0].num);
+  EXPECT_EQ(boxes[0].id, tracked[0].id);
+  EXPECT_NEAR(.5f + 4.f / 200, tracked[0].x, .5f / 200);
+  EXPECT_NEAR(.5f + 2.f / 150, tracked[0].y, .5f / 150);
+  EXPECT_NEAR(.3f, tracked[0].w, .01f);
+}
+
+TEST(BoxTracking, IntervalAdaptsToTrackingConfidence) {
+  const cv::Mat scene = texture(200, 150);
+  BoxTracker tracker(2, 4, .5);
+  std::vector<RosBox_> boxes = {makeBox(.5f, .5f, .3f, .3f, 0)};
+
+  tracker.update(boxes.data(), boxes.size(), scene);
+  EXPECT_FALSE(tracker.keyframeDue());
+  tracker.propagate(scene);
+  EXPECT_TRUE(tracker.keyframeDue());
+
+  // A whole interval tracked, the next one is a frame longer.
+  tracker.update(boxes.data(), boxes.size(), scene);
+  EXPECT_EQ(3, tracker.interval());
+
+  // A blank image loses the box and asks for a keyframe right away.
+  EXPECT_LT(tracker.propagate(cv::Mat(150, 200, CV_8UC1, cv::Scalar(128))), .5);
+  EXPECT_EQ(0, tracker.size());
+  EXPECT_TRUE(tracker.keyframeDue());
+  tracker.update(boxes.data(), boxes.size(), scene);
+  EXPECT_EQ(2, tracker.interval());
+}
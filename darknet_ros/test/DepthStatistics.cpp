@@ -0,0 +1,77 @@
+/*
+ * DepthStatistics.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Depth statistics of boxes.
+#include "darknet_ros/depth_statistics.hpp"
+
+using darknet_ros::DepthEstimator;
+
+TEST(DepthStatistics, IgnoresHoles) {
+  cv::Mat depth(120, 160, CV_16UC1, cv::Scalar(1500));
+  srand(3);
+  for (int i = 0; i < depth.rows * depth.cols / 3; ++i) depth.at<uint16_t>(rand() % depth.rows, rand() % depth.cols) = 0;
+  const cv::Rect box(40, 30, 60, 40);
+  depth.at<uint16_t>(50, 70) = 0;
+
+  EXPECT_EQ(0.f, DepthEstimator(darknet_ros::DEPTH_CENTER, .5, .1, .2, 1).estimate(depth, box));
+  EXPECT_EQ(1500.f, DepthEstimator(darknet_ros::DEPTH_MEDIAN, .5, .1, .2, 1).estimate(depth, box));
+  EXPECT_EQ(1500.f, DepthEstimator(darknet_ros::DEPTH_TRIMMED_MEAN, .5, .1, .2, 1).estimate(depth, box));
+  EXPECT_EQ(1500.f, DepthEstimator(darknet_ros::DEPTH_PERCENTILE, .5, .1, .2, 1).estimate(depth, box));
+
+  // No depth, and boxes outside of the image.
+  const DepthEstimator median(darknet_ros::DEPTH_MEDIAN, .5, .1, .2, 1);
+  EXPECT_EQ(0.f, median.estimate(cv::Mat(120, 160, CV_16UC1, cv::Scalar(0)), box));
+  EXPECT_EQ(0.f, median.estimate(depth, cv::Rect(200, 30, 60, 40)));
+  EXPECT_EQ(0.f, DepthEstimator(darknet_ros::DEPTH_CENTER, .5, .1, .2, 1).estimate(depth, cv::Rect(150, 110, 40, 40)));
+  EXPECT_EQ(1500.f, median.estimate(depth, cv::Rect(130, 90, 60, 60)));
+}
+
+TEST(DepthStatistics, MatchesSortedDepths) {
+  cv::Mat depth(100, 101, CV_16UC1);
+  srand(5);
+  for (int y = 0; y < depth.rows; ++y) {
+    for (int x = 0; x < depth.cols; ++x) {
+      // Holes, near depths sharing the high byte of the holes, and far ones.
+      const int kind = rand() % 4;
+      depth.at<uint16_t>(y, x) = kind == 0 ? 0 : kind == 1 ? rand() % 256 : 500 + rand() % 4000;
+    }
+  }
+  // Small enough to count every pixel.
+  const cv::Rect box(3, 5, 43, 47);
+  std::vector<int> sorted;
+  for (int y = box.y; y < box.br().y; ++y) {
+    for (int x = box.x; x < box.br().x; ++x) {
+      if (depth.at<uint16_t>(y, x) != 0) sorted.push_back(depth.at<uint16_t>(y, x));
+    }
+  }
+  std::sort(sorted.begin(), sorted.end());
+  const int count = sorted.size();
+
+  EXPECT_EQ(sorted[(count - 1) / 2], DepthEstimator(darknet_ros::DEPTH_MEDIAN, 1, .1, .2, 1).estimate(depth, box));
+  EXPECT_EQ(sorted[static_cast<int>(.2 * (count - 1))], DepthEstimator(darknet_ros::DEPTH_PERCENTILE, 1, .1, .2, 1).estimate(depth, box));
+  const int low = static_cast<int>(.1 * count);
+  double sum = 0;
+  for (int i = low; i < count - low; ++i) sum += sorted[i];
+  EXPECT_NEAR(sum / (count - 2 * low), DepthEstimator(darknet_ros::DEPTH_TRIMMED_MEAN, 1, .1, .2, 1).estimate(depth, box), 1e-2);
+
+  // The boxes of a frame split over threads.
+  DepthEstimator estimator(darknet_ros::DEPTH_MEDIAN, .6, .1, .2, 3);
+  std::vector<cv::Rect> boxes;
+  for (int i = 0; i < 50; ++i) boxes.push_back(cv::Rect(rand() % 80, rand() % 80, 10 + rand() % 40, 10 + rand() % 40));
+  std::vector<float> depths(boxes.size());
+  estimator.estimate(depth, boxes.data(), boxes.size(), depths.data());
+  for (size_t i = 0; i < boxes.size(); ++i) EXPECT_EQ(estimator.estimate(depth, boxes[i]), depths[i]);
+}
@@ -0,0 +1,114 @@
+/*
+ * DetectionArena.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+// Reused memory of the decoded detections.
+#include "darknet_ros/detection_arena.hpp"
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+// Post-processing of the decoded detections.
+#include "darknet_ros/box_postprocessing.hpp"
+
+using darknet_ros::BoxPostprocessor;
+using darknet_ros::DetectionArena;
+using darknet_ros::RosBox_;
+
+namespace {
+
+// Two YOLO heads like yolov3, the last one the smaller.
+const char* const kCfg =
+    "[net]\nbatch=1\nwidth=32\nheight=32\nchannels=3\n\n"
+    "[convolutional]\nfilters=14\nsize=1\nstride=4\npad=0\nactivation=linear\n\n"
+    "[yolo]\nmask=0,1\nanchors=10,14, 23,27, 37,58, 81,82\nclasses=2\nnum=4\n\n"
+    "[route]\nlayers=0\n\n"
+    "[convolutional]\nfilters=14\nsize=1\nstride=2\npad=0\nactivation=linear\n\n"
+    "[yolo]\nmask=2,3\nanchors=10,14, 23,27, 37,58, 81,82\nclasses=2\nnum=4\n";
+
+// Allocations through malloc, calloc and realloc while counting is set,
+// operator new included. glibc's allocator is behind the interposed functions.
+bool counting = false;
+size_t allocations = 0;
+
+}  // namespace
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size) {
+  if (counting) ++allocations;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+  if (counting) ++allocations;
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+  if (counting) ++allocations;
+  return __libc_realloc(pointer, size);
+}
+}
+
+TEST(DetectionArena, SizedForAllDetectionLayers) {
+  network* net = darknet_ros::parseNetworkWithBatch(kCfg, 1);
+  const layer& last = net->layers[net->n - 1];
+  EXPECT_EQ(4 * 4 * 2, last.w * last.h * last.n);
+  EXPECT_EQ(8 * 8 * 2 + 4 * 4 * 2, darknet_ros::maxDetections(net));
+
+  DetectionArena arena;
+  arena.resize(net, 3);
+  EXPECT_EQ(3 * darknet_ros::maxDetections(net), arena.capacity());
+  free_network(net);
+}
+
+TEST(DetectionArena, DecodesWithoutAllocating) {
+  network* net = darknet_ros::parseNetworkWithBatch(kCfg, 2);
+  // Every anchor of both heads and images is an object of both classes.
+  for (int i = 0; i < net->n; ++i) {
+    layer& l = net->layers[i];
+    if (l.type == YOLO) std::fill(l.output, l.output + l.outputs * l.batch, .9f);
+  }
+  DetectionArena arena;
+  arena.resize(net, 2);
+  BoxPostprocessor postprocessor;
+  std::vector<RosBox_> boxes(arena.capacity() + 1);
+  const std::vector<cv::Rect> tiles = {cv::Rect(0, 0, 400, 480), cv::Rect(240, 0, 400, 480)};
+
+  int count[2] = {0, 0};
+  int decoded[2] = {0, 0};
+  for (int frame = 0; frame < 2; ++frame) {
+    // The first frame sizes the buffers of the post-processing.
+    counting = frame > 0;
+    allocations = 0;
+    decoded[frame] = darknet_ros::getBatchBoxes(net, 1, 640, 480, .5f, .5f, arena.detections());
+    postprocessor.run(arena.detections(), decoded[frame], 2, .5f, .45f);
+    count[frame] = postprocessor.extract(boxes.data(), boxes.size());
+    const int tiled = darknet_ros::getTiledBoxes(net, 0, 640, 480, tiles, .5f, .5f, arena.detections());
+    EXPECT_EQ(2 * darknet_ros::maxDetections(net), tiled);
+    postprocessor.run(arena.detections(), tiled, 2, .5f, .45f);
+    postprocessor.extract(boxes.data(), boxes.size());
+    counting = false;
+  }
+  EXPECT_EQ(0u, allocations);
+  EXPECT_EQ(darknet_ros::maxDetections(net), decoded[1]);
+  EXPECT_GT(count[1], 0);
+  EXPECT_EQ(count[0], count[1]);
+  free_network(net);
+}
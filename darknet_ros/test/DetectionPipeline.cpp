@@ -0,0 +1,96 @@
+/*
+ * DetectionPipeline.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <vector>
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+using darknet_ros::RosBox_;
+
+namespace {
+
+detection makeDetection(float x, float y, float w, float h, float* prob) {
+  detection det = {};
+  det.bbox.x = x;
+  det.bbox.y = y;
+  det.bbox.w = w;
+  det.bbox.h = h;
+  det.prob = prob;
+  return det;
+}
+
+}  // namespace
+
+TEST(DetectionPipeline, ExtractBoxesClipsAndSkipsTinyBoxes) {
+  float prob0[] = {0.f, 0.8f};
+  float prob1[] = {0.6f, 0.7f};
+  float prob2[] = {0.9f, 0.f};
+  const detection dets[] = {
+      makeDetection(0.1f, 0.5f, 0.4f, 0.2f, prob0),   // clipped on the left
+      makeDetection(0.5f, 0.5f, 0.2f, 0.2f, prob1),   // one box per class
+      makeDetection(0.5f, 0.5f, 0.005f, 0.2f, prob2), // too narrow
+  };
+  std::vector<RosBox_> boxes(8);
+
+  ASSERT_EQ(3, darknet_ros::extractBoxes(dets, 3, 2, boxes.data()));
+  EXPECT_EQ(3, boxes[0].num);
+  EXPECT_FLOAT_EQ(0.15f, boxes[0].x);
+  EXPECT_FLOAT_EQ(0.3f, boxes[0].w);
+  EXPECT_EQ(1, boxes[0].Class);
+  EXPECT_FLOAT_EQ(0.8f, boxes[0].prob);
+  EXPECT_EQ(0, boxes[1].Class);
+  EXPECT_EQ(1, boxes[2].Class);
+  EXPECT_FLOAT_EQ(0.7f, boxes[2].prob);
+}
+
+TEST(DetectionPipeline, ExtractBoxesWithoutDetectionsSetsZeroCount) {
+  std::vector<RosBox_> boxes(1);
+  boxes[0].num = 42;
+  EXPECT_EQ(0, darknet_ros::extractBoxes(nullptr, 0, 80, boxes.data()));
+  EXPECT_EQ(0, boxes[0].num);
+}
+
+TEST(DetectionPipeline, TilesCoverFrameWithOverlap) {
+  EXPECT_EQ(3, darknet_ros::tilesToCover(1920, 960, .2));
+  EXPECT_EQ(2, darknet_ros::tilesToCover(1080, 960, .2));
+  EXPECT_EQ(1, darknet_ros::tilesToCover(416, 960, .2));
+
+  const std::vector<cv::Rect> tiles = darknet_ros::tileFrame(1920, 1080, 3, 2, .2);
+  ASSERT_EQ(6u, tiles.size());
+  for (const cv::Rect& tile : tiles) {
+    EXPECT_EQ(tiles[0].size(), tile.size());
+    EXPECT_EQ(tile, tile & cv::Rect(0, 0, 1920, 1080));
+  }
+  EXPECT_EQ(cv::Point(0, 0), tiles[0].tl());
+  EXPECT_EQ(cv::Point(1920, 1080), tiles[5].br());
+  // Neighbours overlap by at least a fifth of a tile.
+  EXPECT_GE(tiles[0].br().x - tiles[1].x, tiles[0].width / 5);
+  EXPECT_GE(tiles[1].br().x - tiles[2].x, tiles[0].width / 5);
+  EXPECT_GE(tiles[0].br().y - tiles[3].y, tiles[0].height / 5);
+
+  EXPECT_EQ(std::vector<cv::Rect>(1, cv::Rect(0, 0, 640, 480)), darknet_ros::tileFrame(640, 480, 1, 1, .2));
+}
+
+TEST(DetectionPipeline, BackProjectFollowsPinholeModel) {
+  cv::Mat depth(4, 6, CV_16UC1, cv::Scalar(0));
+  depth.at<uint16_t>(3, 5) = 2000;
+  const darknet_ros::DepthIntrinsics_ intrinsics = {1, 2, 4, 8};
+
+  const cv::Point3f point = darknet_ros::backProject(depth, intrinsics, 5, 3);
+  EXPECT_FLOAT_EQ(2.f, point.z);
+  EXPECT_FLOAT_EQ((5 - 1) * 2.f / 4, point.x);
+  EXPECT_FLOAT_EQ((3 - 2) * 2.f / 8, point.y);
+
+  EXPECT_FLOAT_EQ(0.f, darknet_ros::backProject(cv::Mat(), intrinsics, 5, 3).z);
+  EXPECT_FLOAT_EQ(0.f, darknet_ros::backProject(depth, intrinsics, 6, 3).z);
+  EXPECT_FLOAT_EQ(0.f, darknet_ros::backProject(depth, intrinsics, 5, -1).z);
+}
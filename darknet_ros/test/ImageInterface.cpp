@@ -0,0 +1,117 @@
+/*
+ * ImageInterface.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Image interface.
+#include "darknet_ros/image_interface.hpp"
+
+extern "C" image mat_to_image(cv::Mat m);
+
+namespace {
+
+cv::Mat randomBgrImage(int width, int height, unsigned int seed) {
+  cv::Mat mat(height, width, CV_8UC3);
+  cv::RNG rng(seed);
+  rng.fill(mat, cv::RNG::UNIFORM, 0, 256);
+  return mat;
+}
+
+float maxAbsDifference(image a, image b) {
+  float difference = 0;
+  for (int i = 0; i < a.w * a.h * a.c; ++i) {
+    difference = std::max(difference, std::fabs(a.data[i] - b.data[i]));
+  }
+  return difference;
+}
+
+// The path fetchInThread used before: mat_to_image, rgbgr_image and letterbox_image_into.
+image referenceLetterbox(const cv::Mat& mat, int width, int height) {
+  image im = mat_to_image(mat);
+  rgbgr_image(im);
+  image boxed = letterbox_image(im, width, height);
+  free_image(im);
+  return boxed;
+}
+
+}  // namespace
+
+TEST(ImageInterface, LetterboxMatMatchesThreeStepPath) {
+  const int sizes[][2] = {{640, 480}, {1920, 1080}, {300, 600}, {416, 416}, {91, 37}, {200, 100}};
+  const int swapRB = !mat_to_image_swaps_rb();
+  letterbox_plan plan = make_letterbox_plan();
+  for (const auto& size : sizes) {
+    cv::Mat mat = randomBgrImage(size[0], size[1], size[0] * size[1]);
+    image expected = referenceLetterbox(mat, 416, 416);
+    image boxed = make_image(416, 416, 3);
+    fill_image(boxed, -1);
+    letterbox_mat_into(mat, swapRB, boxed, &plan);
+    EXPECT_LT(maxAbsDifference(expected, boxed), 1e-5) << size[0] << "x" << size[1];
+    free_image(expected);
+    free_image(boxed);
+  }
+  free_letterbox_plan(&plan);
+}
+
+TEST(ImageInterface, LetterboxMatHandlesRegionOfInterest) {
+  const int swapRB = !mat_to_image_swaps_rb();
+  cv::Mat mat = randomBgrImage(800, 600, 42);
+  cv::Mat roi = mat(cv::Rect(13, 7, 517, 311));
+  image expected = referenceLetterbox(roi.clone(), 320, 320);
+  image boxed = make_image(320, 320, 3);
+  letterbox_plan plan = make_letterbox_plan();
+  letterbox_mat_into(roi, swapRB, boxed, &plan);
+  EXPECT_LT(maxAbsDifference(expected, boxed), 1e-5);
+  free_letterbox_plan(&plan);
+  free_image(expected);
+  free_image(boxed);
+}
+
+TEST(ImageInterface, MatIntoImageMatchesMatToImage) {
+  const int swapRB = !mat_to_image_swaps_rb();
+  cv::Mat mat = randomBgrImage(641, 479, 7);
+  image expected = mat_to_image(mat);
+  rgbgr_image(expected);
+  image im = make_image(mat.cols, mat.rows, 3);
+  mat_into_image(mat, swapRB, im);
+  EXPECT_LT(maxAbsDifference(expected, im), 1e-6);
+  free_image(expected);
+  free_image(im);
+}
+
+TEST(ImageInterface, GenerateImageMatchesPixelLoop) {
+  image im = make_image(333, 211, 3);
+  for (int i = 0; i < im.w * im.h * im.c; ++i) {
+    im.data[i] = (rand() % 1000) / 999.f;
+  }
+  // Out of range values saturate instead of wrapping.
+  im.data[0] = 1.7f;
+  im.data[1] = -0.3f;
+
+  cv::Mat disp(im.h, im.w, CV_8UC3);
+  generate_image(im, disp, 1);
+  cv::Mat striped(im.h, im.w, CV_8UC3);
+  generate_image(im, striped, 4);
+
+  for (int y = 0; y < im.h; ++y) {
+    for (int x = 0; x < im.w; ++x) {
+      for (int k = 0; k < 3; ++k) {
+        float value = std::min(1.f, std::max(0.f, im.data[(2 - k) * im.w * im.h + y * im.w + x]));
+        unsigned char expected = (unsigned char)(value * 255);
+        ASSERT_EQ(expected, disp.ptr<unsigned char>(y)[3 * x + k]);
+        ASSERT_EQ(expected, striped.ptr<unsigned char>(y)[3 * x + k]);
+      }
+    }
+  }
+  free_image(im);
+}
@@ -0,0 +1,142 @@
+/*
+ * Int8Inference.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <unistd.h>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// OpenCv
+#include <opencv2/highgui/highgui.hpp>
+
+// INT8 convolutions.
+#include "darknet_ros/inference_threads.hpp"
+#include "darknet_ros/int8_inference.hpp"
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+using namespace darknet_ros;
+
+namespace {
+
+// The first convolution stays in FP32, the second runs in INT8.
+const char* const kCfg =
+    "[net]\nbatch=1\nwidth=24\nheight=24\nchannels=3\n\n"
+    "[convolutional]\nfilters=8\nsize=3\nstride=1\npad=1\nactivation=leaky\n\n"
+    "[convolutional]\nfilters=6\nsize=3\nstride=1\npad=1\nactivation=linear\n";
+
+}  // namespace
+
+TEST(Int8Inference, PadsDepthToKernelBlocks) {
+  EXPECT_EQ(32, paddedDepth(1));
+  EXPECT_EQ(32, paddedDepth(32));
+  EXPECT_EQ(96, paddedDepth(75));
+}
+
+TEST(Int8Inference, QuantizedRowsStayWithinHalfAStep) {
+  const int rows = 3;
+  const int k = 27;
+  const int kpad = paddedDepth(k);
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> uniform(-2.f, 2.f);
+  std::vector<float> values(rows * k);
+  for (float& value : values) value = uniform(random);
+  for (int i = 0; i < k; ++i) values[2 * k + i] = 0;  // all zero row
+
+  std::vector<int8_t> quantized(rows * kpad, 1);
+  std::vector<float> scales(rows);
+  quantizeRows(values.data(), rows, k, kpad, quantized.data(), scales.data());
+
+  for (int r = 0; r < rows; ++r) {
+    for (int i = 0; i < k; ++i) {
+      EXPECT_NEAR(values[r * k + i], quantized[r * kpad + i] * scales[r], scales[r] / 2 + 1e-6);
+      EXPECT_LE(std::abs(quantized[r * kpad + i]), 127);
+    }
+    for (int i = k; i < kpad; ++i) EXPECT_EQ(0, quantized[r * kpad + i]);
+  }
+  EXPECT_EQ(0, quantized[2 * kpad]);
+}
+
+TEST(Int8Inference, GemmMatchesIntegerReference) {
+  // Column count not a multiple of the kernel's 4 columns or cache blocks.
+  const int m = 5;
+  const int n = 67;
+  const int kpad = paddedDepth(75);
+  std::mt19937 random(2);
+  std::uniform_int_distribution<int> uniform(-127, 127);
+  std::vector<int8_t> a(m * kpad);
+  std::vector<int8_t> bt(n * kpad);
+  for (int8_t& value : a) value = uniform(random);
+  for (int8_t& value : bt) value = uniform(random);
+  a[0] = bt[0] = -127;  // extremes of both operands
+  a[1] = bt[1] = 127;
+  const std::vector<float> scales = {1.f, .5f, .25f, 2.f, 1e-3f};
+  const float inputScale = .5f;
+  const std::vector<float> biases = {0.f, 1.f, -2.f, .5f, 3.f};
+
+  // Also split over threads, 67 columns are two blocks.
+  for (int threads : {1, 3}) {
+    setInferenceThreads(threads, std::vector<int>());
+    std::vector<float> c(m * n);
+    gemmInt8(m, n, kpad, a.data(), bt.data(), scales.data(), inputScale, biases.data(), c.data());
+
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+        int32_t sum = 0;
+        for (int k = 0; k < kpad; ++k) sum += a[i * kpad + k] * bt[j * kpad + k];
+        EXPECT_FLOAT_EQ(sum * scales[i] * inputScale + biases[i], c[i * n + j])
+            << "row " << i << ", column " << j << ", " << int8KernelName() << ", " << threads << " threads";
+      }
+    }
+  }
+  setInferenceThreads(1, std::vector<int>());
+}
+
+TEST(Int8Inference, ForwardPassMatchesAcrossThreads) {
+  network* net = parseNetworkWithBatch(kCfg, 1);
+  std::mt19937 random(3);
+  std::uniform_real_distribution<float> uniform(-.5f, .5f);
+  for (int i = 0; i < net->n; ++i) {
+    layer& l = net->layers[i];
+    for (int j = 0; j < l.nweights; ++j) l.weights[j] = uniform(random);
+    for (int j = 0; j < l.n; ++j) l.biases[j] = uniform(random);
+  }
+
+  char calibrationFile[] = "/tmp/darknet_ros_int8_test_XXXXXX.png";
+  const int fd = mkstemps(calibrationFile, 4);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  cv::Mat calibrationImage(24, 24, CV_8UC3);
+  cv::randu(calibrationImage, 0, 255);
+  ASSERT_TRUE(cv::imwrite(calibrationFile, calibrationImage));
+  std::string error;
+  EXPECT_EQ(1, quantizeNetwork(net, std::vector<std::string>(1, calibrationFile), error)) << error;
+  unlink(calibrationFile);
+
+  std::vector<float> input(net->inputs);
+  for (float& value : input) value = uniform(random) + .5f;
+  // The rows of the quantized input are split over the threads.
+  std::vector<float> outputs[2];
+  const int threads[] = {1, 3};
+  for (int t = 0; t < 2; ++t) {
+    setInferenceThreads(threads[t], std::vector<int>());
+    const float* output = network_predict(net, input.data());
+    outputs[t].assign(output, output + net->outputs);
+  }
+  setInferenceThreads(1, std::vector<int>());
+  for (int i = 0; i < net->outputs; ++i) EXPECT_FLOAT_EQ(outputs[0][i], outputs[1][i]) << "output " << i;
+
+  releaseQuantizedNetwork(net);
+  free_network(net);
+}
@@ -0,0 +1,68 @@
+/*
+ * LatencyHistogram.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <numeric>
+#include <vector>
+
+// Stage latency statistics.
+#include "darknet_ros/LatencyHistogram.hpp"
+
+using darknet_ros::LatencyHistogram;
+
+TEST(LatencyHistogram, PercentilesOfWindow) {
+  LatencyHistogram histogram(100);
+  std::vector<double> scratch;
+  for (int i = 1; i <= 100; ++i) histogram.add(i);
+
+  EXPECT_EQ(100u, histogram.count());
+  EXPECT_DOUBLE_EQ(50.5, histogram.mean());
+  EXPECT_DOUBLE_EQ(50, histogram.percentile(50, scratch));
+  EXPECT_DOUBLE_EQ(95, histogram.percentile(95, scratch));
+  EXPECT_DOUBLE_EQ(99, histogram.percentile(99, scratch));
+  EXPECT_DOUBLE_EQ(100, histogram.max());
+}
+
+TEST(LatencyHistogram, EvictsOldestSamples) {
+  LatencyHistogram histogram(10);
+  std::vector<double> scratch;
+  for (int i = 0; i < 10; ++i) histogram.add(1000);
+  for (int i = 0; i < 10; ++i) histogram.add(1);
+
+  EXPECT_EQ(10u, histogram.count());
+  EXPECT_DOUBLE_EQ(1, histogram.mean());
+  EXPECT_DOUBLE_EQ(1, histogram.max());
+  EXPECT_DOUBLE_EQ(1, histogram.percentile(99, scratch));
+
+  const std::vector<uint32_t>& counts = histogram.counts();
+  EXPECT_EQ(10u, std::accumulate(counts.begin(), counts.end(), 0u));
+}
+
+TEST(LatencyHistogram, BucketsHoldLatenciesUpToTheirBound) {
+  const std::vector<double>& bounds = LatencyHistogram::bounds();
+  LatencyHistogram histogram(10);
+  histogram.add(bounds[3]);
+  histogram.add(bounds[3] * 1.01);
+  histogram.add(1e9);
+
+  const std::vector<uint32_t>& counts = histogram.counts();
+  ASSERT_EQ(bounds.size() + 1, counts.size());
+  EXPECT_EQ(1u, counts[3]);
+  EXPECT_EQ(1u, counts[4]);
+  EXPECT_EQ(1u, counts.back());
+}
+
+TEST(LatencyHistogram, EmptyHistogramReportsZero) {
+  LatencyHistogram histogram;
+  std::vector<double> scratch;
+  EXPECT_EQ(0u, histogram.count());
+  EXPECT_DOUBLE_EQ(0, histogram.mean());
+  EXPECT_DOUBLE_EQ(0, histogram.percentile(50, scratch));
+}
@@ -0,0 +1,50 @@
+/*
+ * MotionGate.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// Change detection of static scenes.
+#include "darknet_ros/motion_gate.hpp"
+
+using darknet_ros::MotionGate;
+
+TEST(MotionGate, PassesChangedFramesOnly) {
+  MotionGate gate(16, 8, .01, 0);
+  cv::Mat frame(120, 160, CV_8UC3, cv::Scalar(100, 100, 100));
+  EXPECT_TRUE(gate.changed(frame));
+  EXPECT_FALSE(gate.changed(frame));
+
+  // Noise of a few gray levels is no change.
+  cv::Mat noisy = frame.clone();
+  for (int y = 0; y < noisy.rows; ++y) {
+    for (int x = y % 2; x < 3 * noisy.cols; x += 2) noisy.ptr<unsigned char>(y)[x] += 4;
+  }
+  EXPECT_FALSE(gate.changed(noisy));
+  EXPECT_EQ(2, gate.unchangedFrames());
+
+  // A bright object covering a block.
+  cv::Mat moved = frame.clone();
+  for (int y = 40; y < 60; ++y) {
+    for (int x = 3 * 40; x < 3 * 60; ++x) moved.ptr<unsigned char>(y)[x] = 250;
+  }
+  EXPECT_TRUE(gate.changed(moved));
+  EXPECT_EQ(0, gate.unchangedFrames());
+  EXPECT_FALSE(gate.changed(moved));
+
+  // Frames of another size always pass.
+  EXPECT_TRUE(gate.changed(cv::Mat(240, 320, CV_8UC3, cv::Scalar(100, 100, 100))));
+}
+
+TEST(MotionGate, RefreshesAfterInterval) {
+  MotionGate gate(16, 8, .01, 3);
+  const cv::Mat frame(120, 160, CV_8UC3, cv::Scalar(50, 60, 70));
+  EXPECT_TRUE(gate.changed(frame));
+  for (int i = 0; i < 3; ++i) EXPECT_FALSE(gate.changed(frame));
+  EXPECT_TRUE(gate.changed(frame));
+  EXPECT_FALSE(gate.changed(frame));
+}
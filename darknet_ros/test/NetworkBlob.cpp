@@ -0,0 +1,136 @@
+/*
+ * NetworkBlob.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+// Precompiled networks.
+#include "darknet_ros/network_blob.hpp"
+
+// Batch normalization folding.
+#include "darknet_ros/batchnorm_folding.hpp"
+
+extern "C" {
+#include "parser.h"
+}
+
+namespace {
+
+const char* const kCfg =
+    "[net]\nbatch=1\nwidth=8\nheight=8\nchannels=3\n\n"
+    "[convolutional]\nbatch_normalize=1\nfilters=4\nsize=3\nstride=1\npad=1\nactivation=leaky\n\n"
+    "[connected]\noutput=5\nactivation=linear\n";
+
+std::string temporaryFile(const std::string& content) {
+  char name[] = "/tmp/darknet_ros_blob_test_XXXXXX";
+  const int fd = mkstemp(name);
+  EXPECT_GE(fd, 0);
+  EXPECT_EQ(static_cast<ssize_t>(content.size()), write(fd, content.data(), content.size()));
+  close(fd);
+  return name;
+}
+
+void fillRandom(float* data, int n) {
+  for (int i = 0; i < n; ++i) data[i] = rand() / static_cast<float>(RAND_MAX) - .5f;
+}
+
+}  // namespace
+
+TEST(NetworkBlob, RoundTripKeepsWeights) {
+  const std::string cfgFile = temporaryFile(kCfg);
+  const std::string blobFile = temporaryFile("");
+  network* net = parse_network_cfg(const_cast<char*>(cfgFile.c_str()));
+  srand(7);
+  layer& conv = net->layers[0];
+  fillRandom(conv.weights, conv.nweights);
+  fillRandom(conv.biases, conv.n);
+  fillRandom(conv.scales, conv.n);
+  fillRandom(conv.rolling_mean, conv.n);
+  fillRandom(conv.rolling_variance, conv.n);
+  layer& connected = net->layers[1];
+  fillRandom(connected.weights, connected.inputs * connected.outputs);
+  fillRandom(connected.biases, connected.outputs);
+
+  std::string error;
+  ASSERT_TRUE(darknet_ros::writeNetworkBlob(net, cfgFile.c_str(), blobFile.c_str(), error)) << error;
+  network* mapped = darknet_ros::loadNetworkBlob(blobFile.c_str(), 2, error);
+  ASSERT_TRUE(mapped != NULL) << error;
+  EXPECT_EQ(2, mapped->batch);
+  ASSERT_EQ(net->n, mapped->n);
+  for (int i = 0; i < conv.nweights; ++i) EXPECT_EQ(conv.weights[i], mapped->layers[0].weights[i]);
+  for (int i = 0; i < conv.n; ++i) {
+    EXPECT_EQ(conv.biases[i], mapped->layers[0].biases[i]);
+    EXPECT_EQ(conv.rolling_variance[i], mapped->layers[0].rolling_variance[i]);
+  }
+  for (int i = 0; i < connected.inputs * connected.outputs; ++i) EXPECT_EQ(connected.weights[i], mapped->layers[1].weights[i]);
+
+  darknet_ros::freeNetwork(mapped);
+  darknet_ros::freeNetwork(net);
+  unlink(cfgFile.c_str());
+  unlink(blobFile.c_str());
+}
+
+TEST(NetworkBlob, KeepsFoldedBatchNorm) {
+  const std::string cfgFile = temporaryFile(kCfg);
+  const std::string blobFile = temporaryFile("");
+  network* net = parse_network_cfg(const_cast<char*>(cfgFile.c_str()));
+  srand(8);
+  layer& conv = net->layers[0];
+  fillRandom(conv.weights, conv.nweights);
+  fillRandom(conv.biases, conv.n);
+  for (int i = 0; i < conv.n; ++i) {
+    conv.scales[i] = 1 + i;
+    conv.rolling_mean[i] = i;
+    conv.rolling_variance[i] = 4;
+  }
+  ASSERT_EQ(1, darknet_ros::foldBatchNorm(net));
+
+  std::string error;
+  ASSERT_TRUE(darknet_ros::writeNetworkBlob(net, cfgFile.c_str(), blobFile.c_str(), error)) << error;
+  network* mapped = darknet_ros::loadNetworkBlob(blobFile.c_str(), 1, error);
+  ASSERT_TRUE(mapped != NULL) << error;
+  EXPECT_EQ(0, mapped->layers[0].batch_normalize);
+  for (int i = 0; i < conv.nweights; ++i) EXPECT_EQ(conv.weights[i], mapped->layers[0].weights[i]);
+  for (int i = 0; i < conv.n; ++i) EXPECT_EQ(conv.biases[i], mapped->layers[0].biases[i]);
+  EXPECT_EQ(0, darknet_ros::foldBatchNorm(mapped));
+
+  darknet_ros::freeNetwork(mapped);
+  darknet_ros::freeNetwork(net);
+  unlink(cfgFile.c_str());
+  unlink(blobFile.c_str());
+}
+
+TEST(NetworkBlob, RejectsCorruptBlob) {
+  const std::string cfgFile = temporaryFile(kCfg);
+  const std::string blobFile = temporaryFile("");
+  network* net = parse_network_cfg(const_cast<char*>(cfgFile.c_str()));
+  std::string error;
+  ASSERT_TRUE(darknet_ros::writeNetworkBlob(net, cfgFile.c_str(), blobFile.c_str(), error)) << error;
+  darknet_ros::freeNetwork(net);
+
+  // Flip the last byte.
+  {
+    std::fstream blob(blobFile.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    blob.seekg(-1, std::ios::end);
+    const char last = blob.peek();
+    blob.seekp(-1, std::ios::end);
+    blob.put(last ^ 1);
+  }
+  EXPECT_TRUE(darknet_ros::loadNetworkBlob(blobFile.c_str(), 1, error) == NULL);
+  EXPECT_EQ("checksum mismatch", error);
+
+  EXPECT_TRUE(darknet_ros::loadNetworkBlob(cfgFile.c_str(), 1, error) == NULL);
+  unlink(cfgFile.c_str());
+  unlink(blobFile.c_str());
+}
@@ -0,0 +1,117 @@
+/*
+ * PredictionAveraging.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <algorithm>
+
+// Temporal averaging of the predictions.
+#include "darknet_ros/prediction_averaging.hpp"
+
+// Detection stages without ROS.
+#include "darknet_ros/detection_pipeline.hpp"
+
+using darknet_ros::PredictionAverager;
+
+namespace {
+
+// Two YOLO heads like yolov3.
+const char* const kCfg =
+    "[net]\nbatch=1\nwidth=32\nheight=32\nchannels=3\n\n"
+    "[convolutional]\nfilters=14\nsize=1\nstride=4\npad=0\nactivation=linear\n\n"
+    "[yolo]\nmask=0,1\nanchors=10,14, 23,27, 37,58, 81,82\nclasses=2\nnum=4\n\n"
+    "[route]\nlayers=0\n\n"
+    "[convolutional]\nfilters=14\nsize=1\nstride=2\npad=0\nactivation=linear\n\n"
+    "[yolo]\nmask=2,3\nanchors=10,14, 23,27, 37,58, 81,82\nclasses=2\nnum=4\n";
+
+// Sets the outputs of the detection layers for batch image b, those of the
+// last layer to twice the value.
+void setOutputs(network* net, int b, float value) {
+  for (int i = 0; i < net->n; ++i) {
+    layer& l = net->layers[i];
+    if (l.type == YOLO) std::fill(l.output + b * l.outputs, l.output + (b + 1) * l.outputs, i == net->n - 1 ? 2 * value : value);
+  }
+}
+
+}  // namespace
+
+TEST(PredictionAveraging, AveragesTheLastFrames) {
+  network* net = darknet_ros::parseNetworkWithBatch(kCfg, 2);
+  const layer& first = net->layers[1];
+  const layer& last = net->layers[net->n - 1];
+  PredictionAverager averager;
+  averager.resize(net, 3);
+
+  // The mean is over the frames stored so far until the ring is full.
+  const float values[] = {3, 6, 9, 30, 0};
+  const float means[] = {3, 4.5, 6, 15, 13};
+  for (int frame = 0; frame < 5; ++frame) {
+    setOutputs(net, 0, values[frame]);
+    setOutputs(net, 1, values[frame]);
+    averager.update(net, 0, 2);
+    EXPECT_FLOAT_EQ(means[frame], first.output[0]);
+    EXPECT_FLOAT_EQ(means[frame], first.output[first.outputs * first.batch - 1]);
+    EXPECT_FLOAT_EQ(2 * means[frame], last.output[last.outputs * last.batch - 1]);
+  }
+
+  // Resizing forgets the stored frames.
+  averager.resize(net, 2);
+  setOutputs(net, 0, 8);
+  averager.update(net, 0, 1);
+  EXPECT_FLOAT_EQ(8, first.output[0]);
+  free_network(net);
+}
+
+TEST(PredictionAveraging, KeepsStreamsApart) {
+  // Batch image 0 of a camera, image 1 of another one.
+  network* net = darknet_ros::parseNetworkWithBatch(kCfg, 2);
+  const layer& first = net->layers[1];
+  PredictionAverager averager;
+  averager.resize(net, 3);
+
+  setOutputs(net, 0, 3);
+  setOutputs(net, 1, 100);
+  averager.update(net, 0, 2);
+  EXPECT_FLOAT_EQ(3, first.output[0]);
+  EXPECT_FLOAT_EQ(100, first.output[first.outputs]);
+
+  // A goal batch in the entry of the first camera, while the second camera
+  // has no new frame: neither is averaged.
+  setOutputs(net, 0, 50);
+  setOutputs(net, 1, 100);
+  EXPECT_FLOAT_EQ(50, first.output[0]);
+
+  // The next camera batches only see the cameras' own frames.
+  setOutputs(net, 0, 6);
+  setOutputs(net, 1, 200);
+  averager.update(net, 0, 2);
+  EXPECT_FLOAT_EQ(4.5, first.output[0]);
+  EXPECT_FLOAT_EQ(150, first.output[first.outputs]);
+
+  // Images outside of the range are left alone.
+  setOutputs(net, 0, 9);
+  setOutputs(net, 1, 400);
+  averager.update(net, 0, 1);
+  EXPECT_FLOAT_EQ(6, first.output[0]);
+  EXPECT_FLOAT_EQ(400, first.output[first.outputs]);
+  free_network(net);
+}
+
+TEST(PredictionAveraging, LeavesOutputsWithoutAveraging) {
+  network* net = darknet_ros::parseNetworkWithBatch(kCfg, 1);
+  PredictionAverager averager;
+  averager.resize(net, 1);
+  EXPECT_EQ(1, averager.frames());
+  for (int frame = 0; frame < 3; ++frame) {
+    setOutputs(net, 0, frame + 1);
+    averager.update(net, 0, 1);
+    EXPECT_FLOAT_EQ(frame + 1, net->layers[1].output[0]);
+  }
+  free_network(net);
+}
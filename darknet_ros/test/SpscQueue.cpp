@@ -0,0 +1,54 @@
+/*
+ * SpscQueue.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <chrono>
+#include <thread>
+
+// Pipeline hand-off queues.
+#include "darknet_ros/SpscQueue.hpp"
+
+using darknet_ros::SpscQueue;
+
+TEST(SpscQueue, KeepsOrderUpToCapacity) {
+  SpscQueue<int> queue(3);
+  for (int i = 0; i < 3; ++i) EXPECT_TRUE(queue.push(i));
+  EXPECT_FALSE(queue.push(3));
+  EXPECT_EQ(3u, queue.size());
+  int value;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(SpscQueue, WakesParkedConsumer) {
+  SpscQueue<int> queue(3);
+  int value = 0;
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(queue.pop(value, std::chrono::milliseconds(20)));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+  // Every element reaches the consumer well before the timeout.
+  std::thread producer([&queue]() {
+    for (int i = 1; i <= 1000; ++i) {
+      if (i % 100 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      while (!queue.push(i)) std::this_thread::yield();
+    }
+  });
+  start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= 1000; ++i) {
+    ASSERT_TRUE(queue.pop(value, std::chrono::seconds(5)));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  producer.join();
+}
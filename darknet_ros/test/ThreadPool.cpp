@@ -0,0 +1,65 @@
+/*
+ * ThreadPool.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *   Institute: Wavemaker Labs, Inc
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Worker threads.
+#include "darknet_ros/ThreadPool.hpp"
+
+using darknet_ros::ThreadPool;
+
+TEST(ThreadPool, CoversEachIndexOnce) {
+  ThreadPool pool(4);
+  EXPECT_EQ(4, pool.size());
+  for (int count : {1, 3, 4, 1001}) {
+    std::vector<std::atomic<int>> visits(count);
+    for (std::atomic<int>& visit : visits) visit = 0;
+    std::atomic<int> ranges(0);
+    pool.parallelFor(count, [&](int begin, int end) {
+      EXPECT_LT(begin, end);
+      ++ranges;
+      for (int i = begin; i < end; ++i) ++visits[i];
+    });
+    for (int i = 0; i < count; ++i) EXPECT_EQ(1, visits[i]) << "index " << i << " of " << count;
+    EXPECT_EQ(std::min(count, 4), ranges);
+  }
+}
+
+TEST(ThreadPool, RunsOnCallerWithOneThread) {
+  ThreadPool pool(1);
+  const std::thread::id caller = std::this_thread::get_id();
+  int calls = 0;
+  pool.parallelFor(10, [&](int begin, int end) {
+    EXPECT_EQ(caller, std::this_thread::get_id());
+    EXPECT_EQ(0, begin);
+    EXPECT_EQ(10, end);
+    ++calls;
+  });
+  pool.parallelFor(0, [&](int, int) { ++calls; });
+  EXPECT_EQ(1, calls);
+}
+
+TEST(ThreadPool, SerializesConcurrentCallers) {
+  ThreadPool pool(3);
+  std::atomic<int> total(0);
+  std::vector<std::thread> callers;
+  for (int c = 0; c < 4; ++c) {
+    callers.emplace_back([&] {
+      for (int i = 0; i < 100; ++i) {
+        pool.parallelFor(30, [&](int begin, int end) { total += end - begin; });
+      }
+    });
+  }
+  for (std::thread& caller : callers) caller.join();
+  EXPECT_EQ(4 * 100 * 30, total);
+}